@@ -0,0 +1,84 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2020 Nordic Semiconductor ASA
+#
+# SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+#
+
+"""Build the signed Zigbee OTA file used by the OTA verification test.
+
+A deterministic payload is signed with MCUboot's imgtool, like the
+application image, and wrapped in a Zigbee OTA file header with a single
+upgrade image sub-element, like the .zigbee file served by the OTA server.
+"""
+
+import argparse
+import os
+import struct
+import subprocess
+import sys
+import tempfile
+
+OTA_FILE_ID = 0x0BEEF11E
+OTA_HEADER_VERSION = 0x0100
+OTA_HEADER_LEN = 56
+OTA_STACK_VERSION = 0x0002  # Zigbee PRO
+OTA_TAG_UPGRADE_IMAGE = 0x0000
+
+
+def make_payload(size):
+    """Return `size` bytes of fixed, non-repeating looking content."""
+    state = 0x12345678
+    out = bytearray()
+    for _ in range(size):
+        state = (state * 1103515245 + 12345) & 0xFFFFFFFF
+        out.append(state >> 24)
+    return bytes(out)
+
+
+def sign(args, payload):
+    with tempfile.TemporaryDirectory() as tmp:
+        unsigned = os.path.join(tmp, 'app.bin')
+        signed = os.path.join(tmp, 'app.signed.bin')
+        with open(unsigned, 'wb') as f:
+            f.write(payload)
+        subprocess.run([sys.executable, args.imgtool, 'sign',
+                        '--key', args.key,
+                        '--header-size', '0x200', '--pad-header',
+                        '--align', '4',
+                        '--version', '1.2.3+4',
+                        '--slot-size', '0x10000',
+                        unsigned, signed], check=True)
+        with open(signed, 'rb') as f:
+            return f.read()
+
+
+def ota_file(args, image):
+    element = struct.pack('<HI', OTA_TAG_UPGRADE_IMAGE, len(image)) + image
+    header_string = b'light_switch OTA test'.ljust(32, b'\0')
+    header = struct.pack('<IHHHHHIH32sI', OTA_FILE_ID, OTA_HEADER_VERSION,
+                         OTA_HEADER_LEN, 0, args.manufacturer, args.image_type,
+                         args.file_version, OTA_STACK_VERSION, header_string,
+                         OTA_HEADER_LEN + len(element))
+    assert len(header) == OTA_HEADER_LEN
+    return header + element
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('--imgtool', required=True, help='path to imgtool.py')
+    parser.add_argument('--key', required=True, help='image signing key')
+    parser.add_argument('--output', required=True, help='OTA file to write')
+    parser.add_argument('--payload-size', type=int, default=4000)
+    parser.add_argument('--manufacturer', type=lambda x: int(x, 0), default=0x1234)
+    parser.add_argument('--image-type', type=lambda x: int(x, 0), default=0x0141)
+    parser.add_argument('--file-version', type=lambda x: int(x, 0), default=0x01020304)
+    args = parser.parse_args()
+
+    image = sign(args, make_payload(args.payload_size))
+    with open(args.output, 'wb') as f:
+        f.write(ota_file(args, image))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @file main.c
+ * @brief OTA stream verification test
+ *
+ * Feeds a Zigbee OTA file holding an imgtool-signed MCUboot image (see
+ * make_ota_file.py) through ota_verify_value_cb() the way the OTA client
+ * delivers it: a start, file blocks by offset, then the check step. The
+ * intact file must pass in every block size and with retransmitted blocks.
+ * A gap in the offsets, a flipped image byte, a bad TLV area magic and a
+ * missing SHA-256 TLV must each be rejected.
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/sys/byteorder.h>
+#include <string.h>
+
+#include <zboss_api.h>
+#include "ota_verify.h"
+
+/* Zigbee OTA file and MCUboot image layout, as parsed by ota_verify.c */
+#define OTA_HEADER_LEN_OFFSET   6
+#define OTA_SUBELEMENT_HDR_LEN  6
+#define IMAGE_HDR_SIZE_OFFSET   8
+#define IMAGE_PROT_TLV_OFFSET   10
+#define IMAGE_IMG_SIZE_OFFSET   12
+#define IMAGE_TLV_INFO_LEN      4
+#define IMAGE_TLV_HDR_LEN       4
+#define IMAGE_TLV_SHA256        0x10
+#define IMAGE_TLV_UNKNOWN       0xff
+
+/* OTA clients request blocks of up to 255 bytes (8-bit data length) */
+static const uint32_t block_sizes[] = { 1, 7, 32, 48, 64, 100, 255 };
+
+static const uint8_t ota_file[] = {
+#include "test_image.zigbee.inc"
+};
+
+/* Mutable copy for the corrupted variants */
+static uint8_t file[sizeof(ota_file)];
+
+/* File offsets found by walking the layout once */
+static struct {
+	uint32_t image;      /* MCUboot image header */
+	uint32_t body;       /* First byte after the image header */
+	uint32_t body_len;
+	uint32_t tlv_info;   /* Unprotected TLV area info */
+	uint32_t sha_tlv;    /* SHA-256 TLV header */
+} layout;
+
+static uint8_t value_cb(zb_zcl_ota_upgrade_value_param_t *value, bool *forward)
+{
+	*forward = ota_verify_value_cb(value);
+	return value->upgrade_status;
+}
+
+static bool start(void)
+{
+	zb_zcl_ota_upgrade_value_param_t value = {
+		.upgrade_status = ZB_ZCL_OTA_UPGRADE_STATUS_START,
+		.upgrade.start.file_length = sizeof(file),
+	};
+	bool forward;
+
+	value_cb(&value, &forward);
+	return forward;
+}
+
+static bool receive(uint32_t offset, uint32_t len)
+{
+	zb_zcl_ota_upgrade_value_param_t value = {
+		.upgrade_status = ZB_ZCL_OTA_UPGRADE_STATUS_RECEIVE,
+		.upgrade.receive = {
+			.file_offset = offset,
+			.data_length = len,
+			.block_data = &file[offset],
+		},
+	};
+	bool forward;
+	uint8_t status = value_cb(&value, &forward);
+
+	/* A rejection always tells the OTA client through the status */
+	zassert_equal(forward, status != ZB_ZCL_OTA_UPGRADE_STATUS_ERROR,
+		      "block at %u: forward %d with status %u", offset, forward, status);
+	return forward;
+}
+
+static bool check(void)
+{
+	zb_zcl_ota_upgrade_value_param_t value = {
+		.upgrade_status = ZB_ZCL_OTA_UPGRADE_STATUS_CHECK,
+	};
+	bool forward;
+	uint8_t status = value_cb(&value, &forward);
+
+	zassert_equal(forward, status != ZB_ZCL_OTA_UPGRADE_STATUS_ERROR);
+	return forward;
+}
+
+static void abort_transfer(void)
+{
+	zb_zcl_ota_upgrade_value_param_t value = {
+		.upgrade_status = ZB_ZCL_OTA_UPGRADE_STATUS_ABORT,
+	};
+	bool forward;
+
+	value_cb(&value, &forward);
+}
+
+/* Send the whole file in `block` byte blocks; false once a block is rejected */
+static bool receive_all(uint32_t block)
+{
+	for (uint32_t offset = 0; offset < sizeof(file); offset += block) {
+		if (!receive(offset, MIN(block, sizeof(file) - offset))) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool transfer(uint32_t block)
+{
+	zassert_true(start());
+	return receive_all(block) && check();
+}
+
+static void *ota_verify_setup(void)
+{
+	uint32_t hdr_len = sys_get_le16(&ota_file[OTA_HEADER_LEN_OFFSET]);
+	const uint8_t *image;
+	uint32_t tlv, tlv_end;
+
+	zassert_ok(ota_verify_init());
+
+	layout.image = hdr_len + OTA_SUBELEMENT_HDR_LEN;
+	image = &ota_file[layout.image];
+	layout.body = layout.image + sys_get_le16(&image[IMAGE_HDR_SIZE_OFFSET]);
+	layout.body_len = sys_get_le32(&image[IMAGE_IMG_SIZE_OFFSET]);
+	layout.tlv_info = layout.body + layout.body_len +
+			  sys_get_le16(&image[IMAGE_PROT_TLV_OFFSET]);
+
+	tlv = layout.tlv_info + IMAGE_TLV_INFO_LEN;
+	tlv_end = layout.tlv_info + sys_get_le16(&ota_file[layout.tlv_info + 2]);
+	while (tlv + IMAGE_TLV_HDR_LEN <= tlv_end) {
+		if (sys_get_le16(&ota_file[tlv]) == IMAGE_TLV_SHA256) {
+			layout.sha_tlv = tlv;
+			break;
+		}
+		tlv += IMAGE_TLV_HDR_LEN + sys_get_le16(&ota_file[tlv + 2]);
+	}
+
+	zassert_true(layout.body_len > 0, "no image body");
+	zassert_not_equal(layout.sha_tlv, 0, "test image has no SHA-256 TLV");
+
+	return NULL;
+}
+
+static void ota_verify_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	memcpy(file, ota_file, sizeof(file));
+	/* Leave no transfer behind from the previous test */
+	abort_transfer();
+}
+
+ZTEST(ota_verify, test_block_sizes)
+{
+	for (int i = 0; i < ARRAY_SIZE(block_sizes); i++) {
+		zassert_true(transfer(block_sizes[i]), "rejected with %u B blocks",
+			     block_sizes[i]);
+	}
+}
+
+ZTEST(ota_verify, test_retransmitted_blocks)
+{
+	for (int i = 0; i < ARRAY_SIZE(block_sizes); i++) {
+		uint32_t block = block_sizes[i];
+		/* Each block repeats the second half of the previous one */
+		uint32_t step = MAX(block / 2, 1);
+
+		zassert_true(start());
+
+		for (uint32_t offset = 0; offset < sizeof(file); offset += step) {
+			uint32_t len = MIN(block, sizeof(file) - offset);
+
+			zassert_true(receive(offset, len));
+			/* Then the whole block again */
+			zassert_true(receive(offset, len));
+		}
+
+		zassert_true(check(), "rejected with %u B blocks", block);
+	}
+}
+
+ZTEST(ota_verify, test_offset_gap)
+{
+	uint32_t block = 64;
+
+	zassert_true(start());
+	zassert_true(receive(0, block));
+	zassert_false(receive(2 * block, block), "skipped block accepted");
+}
+
+ZTEST(ota_verify, test_flipped_body_byte)
+{
+	file[layout.body + layout.body_len / 2] ^= 0x01;
+
+	for (int i = 0; i < ARRAY_SIZE(block_sizes); i++) {
+		zassert_true(start());
+		zassert_true(receive_all(block_sizes[i]));
+		zassert_false(check(), "corrupt image accepted with %u B blocks",
+			      block_sizes[i]);
+	}
+}
+
+ZTEST(ota_verify, test_bad_tlv_magic)
+{
+	file[layout.tlv_info] ^= 0xff;
+
+	for (int i = 0; i < ARRAY_SIZE(block_sizes); i++) {
+		zassert_true(start());
+		zassert_false(receive_all(block_sizes[i]),
+			      "bad TLV magic accepted with %u B blocks", block_sizes[i]);
+	}
+}
+
+ZTEST(ota_verify, test_missing_sha256_tlv)
+{
+	/* Still a well-formed TLV, just not one the verifier looks for */
+	sys_put_le16(IMAGE_TLV_UNKNOWN, &file[layout.sha_tlv]);
+
+	for (int i = 0; i < ARRAY_SIZE(block_sizes); i++) {
+		zassert_true(start());
+		zassert_true(receive_all(block_sizes[i]));
+		zassert_false(check(), "image without SHA-256 TLV accepted with %u B blocks",
+			      block_sizes[i]);
+	}
+}
+
+ZTEST(ota_verify, test_restart_after_abort)
+{
+	/* Abort inside the image header, then download the file again */
+	zassert_true(start());
+	zassert_true(receive(0, layout.image + 10));
+	abort_transfer();
+
+	zassert_true(transfer(64));
+}
+
+ZTEST_SUITE(ota_verify, NULL, ota_verify_setup, ota_verify_before, NULL, NULL);
@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @file zboss_api.h
+ * @brief OTA verification test stand-in for the ZBOSS OTA upgrade types
+ *
+ * Only the OTA upgrade value callback parameter used by ota_verify.c, with
+ * the same field names and widths as ZBOSS.
+ */
+
+#ifndef ZBOSS_API_H
+#define ZBOSS_API_H
+
+#include <stdint.h>
+
+typedef uint8_t zb_uint8_t;
+typedef uint16_t zb_uint16_t;
+typedef uint32_t zb_uint32_t;
+
+#define ZB_ZCL_OTA_UPGRADE_STATUS_START   0
+#define ZB_ZCL_OTA_UPGRADE_STATUS_APPLY   1
+#define ZB_ZCL_OTA_UPGRADE_STATUS_RECEIVE 2
+#define ZB_ZCL_OTA_UPGRADE_STATUS_FINISH  3
+#define ZB_ZCL_OTA_UPGRADE_STATUS_ABORT   4
+#define ZB_ZCL_OTA_UPGRADE_STATUS_CHECK   5
+#define ZB_ZCL_OTA_UPGRADE_STATUS_OK      6
+#define ZB_ZCL_OTA_UPGRADE_STATUS_ERROR   7
+
+typedef struct {
+	zb_uint16_t manufacturer;
+	zb_uint16_t image_type;
+	zb_uint32_t file_version;
+	zb_uint32_t file_length;
+} zb_zcl_ota_upgrade_start_param_t;
+
+typedef struct {
+	zb_uint32_t file_offset;
+	zb_uint8_t data_length;
+	zb_uint8_t *block_data;
+} zb_zcl_ota_upgrade_receive_param_t;
+
+typedef struct {
+	zb_uint8_t upgrade_status;
+	union {
+		zb_zcl_ota_upgrade_start_param_t start;
+		zb_zcl_ota_upgrade_receive_param_t receive;
+	} upgrade;
+} zb_zcl_ota_upgrade_value_param_t;
+
+#endif /* ZBOSS_API_H */
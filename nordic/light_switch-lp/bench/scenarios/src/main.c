@@ -0,0 +1,331 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @file main.c
+ * @brief Wake-count scenario benchmark
+ *
+ * Runs scripted scenarios against the application's hardware-independent
+ * modules (GPIO control, button handler, On/Off burst collapse, ADC reader,
+ * actuation scheduler, performance counters) on native_sim, where simulated
+ * time makes an idle hour take milliseconds. Presses come in through the
+ * GPIO emulator and On/Off commands through the simulated ZBOSS thread.
+ * A multi-channel scenario switches every relay gang at once to exercise
+ * the actuation scheduler's staggering under the peak current budget.
+ * Each scenario's wake-ups, ADC conversions, relay actuations and Zigbee
+ * frames are checked against the CONFIG_BENCH_* budgets. One BENCH_RESULT
+ * JSON line is printed for trend tracking, then BENCH PASS or BENCH FAIL.
+ */
+
+#include <zephyr/kernel.h>
+
+#include "adc_reader.h"
+#include "actuation_scheduler.h"
+#include "button_handler.h"
+#include "gpio_control.h"
+#include "perf_counters.h"
+#include "zigbee_device.h"
+#include "sim_device.h"
+
+#define BATTERY_FULL_MV  4200
+#define BATTERY_EMPTY_MV 3000
+
+#define PRESS_COUNT      100
+#define PRESS_HOLD_MS    100
+#define PRESS_PERIOD_MS  1000
+#define BURST_COUNT      21  /* Odd: the burst ends away from the initial state */
+#define BURST_PERIOD_MS  1
+#define SPREAD_COUNT     7   /* Odd, like the burst */
+/* One command per poll, polls closer than the collapse window */
+#define SPREAD_PERIOD_MS (CONFIG_ONOFF_COLLAPSE_WINDOW_MS * 3 / 4)
+#define DISCHARGE_HOURS  10
+
+/* The spread must outlast one window, or it would not need the re-arm */
+BUILD_ASSERT((SPREAD_COUNT - 1) * SPREAD_PERIOD_MS > CONFIG_ONOFF_COLLAPSE_WINDOW_MS);
+BUILD_ASSERT((SPREAD_COUNT - 1) * SPREAD_PERIOD_MS < CONFIG_ONOFF_COLLAPSE_MAX_MS);
+
+struct scenario_result {
+	const char *name;
+	struct sim_counts sim;
+	uint32_t adc_conversions;
+	uint32_t actuations;
+	uint32_t wakeup_budget;     /* 0 = not checked */
+	uint32_t adc_budget;        /* 0 = not checked */
+	uint32_t actuation_budget;  /* 0 = not checked */
+	uint32_t frame_budget;      /* 0 = not checked */
+	bool pass;
+};
+
+static struct scenario_result results[6];
+static int result_count;
+
+static void scenario_begin(void)
+{
+	struct sim_counts discard;
+
+	k_sleep(K_MSEC(1));
+	perf_counters_reset();
+	actuation_scheduler_reset_stats();
+	sim_counts_take(&discard);
+}
+
+static bool within(uint32_t value, uint32_t budget)
+{
+	return budget == 0 || value <= budget;
+}
+
+static void scenario_end(const char *name, uint32_t wakeup_budget, uint32_t adc_budget,
+			 uint32_t actuation_budget, uint32_t frame_budget)
+{
+	struct scenario_result *r = &results[result_count++];
+	struct actuation_stats act;
+
+	/* Let collapsed commits, deferred actuations, pulses and held-off
+	 * reports finish
+	 */
+	k_sleep(K_MSEC(CONFIG_ONOFF_COLLAPSE_WINDOW_MS + CONFIG_ACTUATION_PULSE_MS * 2));
+
+	actuation_scheduler_get_stats(&act);
+	sim_counts_take(&r->sim);
+	r->name = name;
+	r->adc_conversions = perf_counter_get(PERF_ADC_CONVERSION);
+	r->actuations = act.actuations;
+	r->wakeup_budget = wakeup_budget;
+	r->adc_budget = adc_budget;
+	r->actuation_budget = actuation_budget;
+	r->frame_budget = frame_budget;
+	r->pass = within(r->sim.wakeups, wakeup_budget) &&
+		  within(r->adc_conversions, adc_budget) &&
+		  within(r->actuations, actuation_budget) &&
+		  within(r->sim.frames, frame_budget);
+
+	printk("%-18s %s: %u wake-ups (budget %u), %u ADC conversions (budget %u), "
+	       "%u actuations (budget %u), %u frames (budget %u)\n",
+	       name, r->pass ? "ok" : "OVER BUDGET",
+	       r->sim.wakeups, wakeup_budget, r->adc_conversions, adc_budget,
+	       r->actuations, actuation_budget, r->sim.frames, frame_budget);
+}
+
+static void idle_hour(void)
+{
+	scenario_begin();
+	k_sleep(K_HOURS(1));
+	scenario_end("idle_hour", CONFIG_BENCH_IDLE_HOUR_WAKEUP_BUDGET,
+		     CONFIG_BENCH_IDLE_HOUR_ADC_BUDGET, 0, 0);
+}
+
+static void button_presses(void)
+{
+	struct button_latency_stats btn;
+
+	/* Clean short presses on the emulated button pin */
+	scenario_begin();
+	button_handler_reset_latency();
+	for (int i = 0; i < PRESS_COUNT; i++) {
+		sim_button_set(true);
+		k_sleep(K_MSEC(PRESS_HOLD_MS));
+		sim_button_set(false);
+		k_sleep(K_MSEC(PRESS_PERIOD_MS - PRESS_HOLD_MS));
+	}
+	scenario_end("button_presses", CONFIG_BENCH_PRESS_WAKEUP_BUDGET, 0,
+		     CONFIG_BENCH_PRESS_ACTUATION_BUDGET, CONFIG_BENCH_PRESS_FRAME_BUDGET);
+
+	/* Every press must have been acted upon, and reported only when
+	 * CONFIG_BUTTON_PRESS_REPORT asks for it
+	 */
+	struct scenario_result *r = &results[result_count - 1];
+	uint32_t reports = IS_ENABLED(CONFIG_BUTTON_PRESS_REPORT) ? PRESS_COUNT : 0;
+
+	button_handler_get_latency(&btn);
+	if (btn.presses != PRESS_COUNT || btn.frames != reports || r->sim.frames != reports) {
+		printk("button_presses: %u of %u presses handled, %u reported, "
+		       "%u frames, expected %u\n",
+		       btn.presses, PRESS_COUNT, btn.frames, r->sim.frames, reports);
+		r->pass = false;
+	}
+}
+
+/* Switch relay0 through the device layer and the other gangs directly */
+static void switch_all_channels(bool on)
+{
+	zigbee_device_set_relay(on);
+	for (uint8_t ch = 1; ch < relay_channel_count(); ch++) {
+		actuation_request(ch, on);
+	}
+}
+
+static void multi_channel(void)
+{
+	uint8_t count = relay_channel_count();
+	bool initial = zigbee_device_get_relay_state();
+	struct actuation_stats act;
+	struct scenario_result *r;
+
+	/* Start from every gang in relay0's state, then flip them all at once */
+	switch_all_channels(initial);
+	k_sleep(K_MSEC(CONFIG_ACTUATION_PULSE_MS * (count + 1)));
+
+	scenario_begin();
+	switch_all_channels(!initial);
+	/* Worst case, the pulses run one after another */
+	k_sleep(K_MSEC(CONFIG_ACTUATION_PULSE_MS * count));
+	scenario_end("multi_channel", 0, 0, count, 0);
+
+	/* Every gang switched once, and no pulse start exceeded the budget */
+	r = &results[result_count - 1];
+	actuation_scheduler_get_stats(&act);
+	for (uint8_t ch = 0; ch < count; ch++) {
+		if (sim_relay_get(ch) == initial) {
+			printk("multi_channel: relay %u not switched\n", ch);
+			r->pass = false;
+		}
+	}
+	if (r->actuations != count || act.peak_load_ma > CONFIG_ACTUATION_PEAK_BUDGET_MA) {
+		printk("multi_channel: %u actuations of %u, peak %u mA (budget %d mA)\n",
+		       r->actuations, count, act.peak_load_ma, CONFIG_ACTUATION_PEAK_BUDGET_MA);
+		r->pass = false;
+	}
+
+	/* Put the extra gangs back so later scenarios see relay0 only */
+	switch_all_channels(initial);
+	k_sleep(K_MSEC(CONFIG_ACTUATION_PULSE_MS * (count + 1)));
+}
+
+/* Explicit On and Off commands `period_ms` apart, alternating from the
+ * opposite of the current state so the last one changes it. They must
+ * collapse to exactly one actuation, to the last commanded state.
+ */
+static void onoff_commands(const char *name, int count, int period_ms, uint32_t frame_budget)
+{
+	bool on = zigbee_device_get_relay_state();
+	struct scenario_result *r;
+
+	scenario_begin();
+	for (int i = 0; i < count; i++) {
+		on = !on;
+		sim_onoff_command(on);
+		k_sleep(K_MSEC(period_ms));
+	}
+	scenario_end(name, 0, 0, 1, frame_budget);
+
+	r = &results[result_count - 1];
+	if (r->actuations != 1 || zigbee_device_get_relay_state() != on ||
+	    sim_relay_get(0) != on) {
+		printk("%s: %u actuations, relay %s, output %s, expected %s\n", name,
+		       r->actuations, zigbee_device_get_relay_state() ? "ON" : "OFF",
+		       sim_relay_get(0) ? "ON" : "OFF", on ? "ON" : "OFF");
+		r->pass = false;
+	}
+}
+
+/* Commands drained from the parent in one poll */
+static void command_burst(void)
+{
+	onoff_commands("command_burst", BURST_COUNT, BURST_PERIOD_MS,
+		       CONFIG_BENCH_BURST_FRAME_BUDGET);
+}
+
+/* A backlog the parent delivers one command per poll, over several polls */
+static void command_spread(void)
+{
+	onoff_commands("command_spread", SPREAD_COUNT, SPREAD_PERIOD_MS,
+		       CONFIG_BENCH_SPREAD_FRAME_BUDGET);
+}
+
+static void battery_discharge(void)
+{
+	int32_t step_mv = (BATTERY_FULL_MV - BATTERY_EMPTY_MV) / DISCHARGE_HOURS;
+
+	scenario_begin();
+	for (int h = 0; h < DISCHARGE_HOURS; h++) {
+		sim_battery_set(BATTERY_FULL_MV - h * step_mv);
+		k_sleep(K_HOURS(1));
+	}
+	scenario_end("battery_discharge", CONFIG_BENCH_DISCHARGE_WAKEUP_BUDGET,
+		     CONFIG_BENCH_DISCHARGE_ADC_BUDGET, 0, CONFIG_BENCH_DISCHARGE_FRAME_BUDGET);
+}
+
+static bool print_report(void)
+{
+	bool pass = true;
+
+	printk("BENCH_RESULT {\"adc_interval_s\":%d,\"scenarios\":[",
+	       CONFIG_ADC_READING_INTERVAL_SEC);
+
+	for (int i = 0; i < result_count; i++) {
+		const struct scenario_result *r = &results[i];
+
+		printk("%s{\"name\":\"%s\",\"pass\":%s,"
+		       "\"wakeups\":%u,\"wakeup_budget\":%u,"
+		       "\"adc_conversions\":%u,\"adc_budget\":%u,"
+		       "\"actuations\":%u,\"actuation_budget\":%u,"
+		       "\"frames\":%u,\"frame_budget\":%u}",
+		       i ? "," : "", r->name, r->pass ? "true" : "false",
+		       r->sim.wakeups, r->wakeup_budget,
+		       r->adc_conversions, r->adc_budget,
+		       r->actuations, r->actuation_budget,
+		       r->sim.frames, r->frame_budget);
+
+		pass = pass && r->pass;
+	}
+
+	printk("]}\n");
+	return pass;
+}
+
+/* Twister's console harness only matches the pass line; the fatal error
+ * makes it fail the run at once instead of at the timeout.
+ */
+static void bench_fail(void)
+{
+	printk("BENCH FAIL\n");
+	k_oops();
+}
+
+int main(void)
+{
+	int err;
+
+	sim_battery_set(BATTERY_FULL_MV);
+
+	err = sim_device_init();
+	if (!err) {
+		err = gpio_control_init();
+	}
+	if (!err) {
+		err = button_handler_init(NULL);
+	}
+	if (err) {
+		printk("Device init failed: %d\n", err);
+		bench_fail();
+		return 0;
+	}
+
+	err = adc_reader_init();
+	if (err) {
+		printk("ADC init failed: %d\n", err);
+		bench_fail();
+		return 0;
+	}
+
+	actuation_scheduler_init();
+	adc_start_periodic_reading();
+
+	idle_hour();
+	button_presses();
+	multi_channel();
+	command_burst();
+	command_spread();
+	battery_discharge();
+
+	if (!print_report()) {
+		bench_fail();
+		return 0;
+	}
+
+	printk("BENCH PASS\n");
+	return 0;
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @file sim_device.h
+ * @brief Simulated hardware and Zigbee boundary for the scenario benchmark
+ */
+
+#ifndef SIM_DEVICE_H
+#define SIM_DEVICE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Counts taken at the simulated boundary
+ */
+struct sim_counts {
+	uint32_t wakeups;  /* CPU idle entries */
+	uint32_t frames;   /* Zigbee frames the application makes the radio send */
+};
+
+/**
+ * @brief Start the simulated ZBOSS scheduler
+ *
+ * @return 0 on success, negative error code on failure
+ */
+int sim_device_init(void);
+
+/**
+ * @brief Set the simulated battery voltage seen by the ADC
+ *
+ * @param voltage_mv Battery voltage in millivolts
+ * @return 0 on success, negative error code on failure
+ */
+int sim_battery_set(int32_t voltage_mv);
+
+/**
+ * @brief Drive the emulated button input
+ *
+ * The GPIO emulator raises the edge interrupt the button handler listens to.
+ *
+ * @param pressed true to press, false to release
+ * @return 0 on success, negative error code on failure
+ */
+int sim_button_set(bool pressed);
+
+/**
+ * @brief Deliver a ZCL On/Off command to the relay endpoint
+ *
+ * Runs the On/Off command path of zigbee_device.c in the simulated ZBOSS
+ * thread: the relay state is updated, the command is answered with a
+ * Default Response frame and handed to the burst collapse.
+ *
+ * @param on Commanded state
+ */
+void sim_onoff_command(bool on);
+
+/**
+ * @brief Read an emulated relay output
+ *
+ * @param channel Relay channel (relayN alias)
+ * @return true if the channel is driven on
+ */
+bool sim_relay_get(uint8_t channel);
+
+/**
+ * @brief Read and clear the boundary counts
+ *
+ * @param[out] counts Counts since the previous call
+ */
+void sim_counts_take(struct sim_counts *counts);
+
+#endif /* SIM_DEVICE_H */
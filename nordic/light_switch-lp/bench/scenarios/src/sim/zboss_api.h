@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @file zboss_api.h
+ * @brief Scenario benchmark stand-in for the ZBOSS scheduler API
+ *
+ * Callbacks and alarms run in order on a dedicated "ZBOSS" work queue
+ * thread, like the ZBOSS scheduler runs them on the Zigbee thread. Alarm
+ * delays are in milliseconds. Alarms are cancelled by callback and
+ * parameter (or ZB_ALARM_ANY_PARAM). See sim_device.c.
+ */
+
+#ifndef ZBOSS_API_H
+#define ZBOSS_API_H
+
+#include <stdint.h>
+
+typedef uint8_t zb_uint8_t;
+typedef uint8_t zb_bufid_t;
+typedef int32_t zb_ret_t;
+typedef void (*zb_callback_t)(zb_uint8_t param);
+
+#define RET_OK        0
+#define RET_OVERFLOW  (-1)
+#define RET_NOT_FOUND (-2)
+
+#define ZB_MILLISECONDS_TO_BEACON_INTERVAL(ms) (ms)
+
+#define ZB_ALARM_ANY_PARAM ((zb_uint8_t)(-1))
+
+#define ZB_SCHEDULE_APP_CALLBACK(func, param)     sim_zb_schedule((func), (param), 0)
+#define ZB_SCHEDULE_APP_ALARM(func, param, delay) sim_zb_schedule((func), (param), (delay))
+#define ZB_SCHEDULE_APP_ALARM_CANCEL(func, param) sim_zb_cancel((func), (param))
+
+zb_ret_t sim_zb_schedule(zb_callback_t func, zb_uint8_t param, uint32_t delay_ms);
+zb_ret_t sim_zb_cancel(zb_callback_t func, zb_uint8_t param);
+
+void zb_bdb_reset_via_local_action(zb_uint8_t param);
+
+#endif /* ZBOSS_API_H */
@@ -0,0 +1,17 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @file zigbee_app_utils.h
+ * @brief Scenario benchmark stand-in for the Zigbee application utilities
+ */
+
+#ifndef ZIGBEE_APP_UTILS_H
+#define ZIGBEE_APP_UTILS_H
+
+void user_input_indicate(void);
+
+#endif /* ZIGBEE_APP_UTILS_H */
@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @file zigbee_device.h
+ * @brief Scenario benchmark stand-in for the ZBOSS-facing device API
+ *
+ * Replaces the application's zigbee_device.h, which pulls in ZBOSS, with the
+ * subset the modules under test call. See sim_device.c.
+ */
+
+#ifndef ZIGBEE_DEVICE_H
+#define ZIGBEE_DEVICE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+void zigbee_device_set_relay(bool on);
+
+bool zigbee_device_toggle_relay(void);
+
+bool zigbee_device_report_relay(void (*sent_cb)(bool sent));
+
+bool zigbee_device_get_relay_state(void);
+
+void zigbee_device_update_battery(int32_t voltage_mv);
+
+#endif /* ZIGBEE_DEVICE_H */
@@ -0,0 +1,272 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @file sim_device.c
+ * @brief Simulated hardware and Zigbee boundary for the scenario benchmark
+ *
+ * The button and relay are the application's GPIOs on the GPIO emulator, and
+ * the battery is fed through the emulated ADC, so gpio_control.c,
+ * button_handler.c and the ADC reader run unchanged. ZBOSS is replaced by a
+ * work queue thread that runs scheduled callbacks and alarms, and the
+ * Zigbee device layer by the relay state and the On/Off command path of
+ * zigbee_device.c. Whether a report is sent is decided by the application's
+ * report_policy.c; a frame is counted wherever zigbee_device.c would hand
+ * one to the stack. ZBOSS answers each On/Off command with a Default
+ * Response, which is counted here. Wake-ups are counted from the
+ * kernel's idle tracing hook: every return to idle ends one wake-up.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/adc/adc_emul.h>
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/sys/atomic.h>
+
+#include <zboss_api.h>
+#include <zigbee/zigbee_app_utils.h>
+
+#include "actuation_scheduler.h"
+#include "gpio_control.h"
+#include "onoff_collapse.h"
+#include "report_policy.h"
+#include "zigbee_device.h"
+#include "sim_device.h"
+
+#define ADC_INPUTS_NODE DT_COMPAT_GET_ANY_STATUS_OKAY(fcapps_adc_inputs)
+#define VBAT_NODE       DT_CHILD(ADC_INPUTS_NODE, vbat)
+
+/* Callbacks and alarms pending at the same time */
+#define SIM_ZB_CALLBACKS 8
+#define SIM_ZB_STACK_SIZE 2048
+
+static const struct device *const adc_dev = DEVICE_DT_GET(DT_IO_CHANNELS_CTLR(VBAT_NODE));
+static const struct gpio_dt_spec relays[] = {
+	GPIO_DT_SPEC_GET(DT_ALIAS(relay0), gpios),
+	GPIO_DT_SPEC_GET(DT_ALIAS(relay1), gpios),
+	GPIO_DT_SPEC_GET(DT_ALIAS(relay2), gpios),
+	GPIO_DT_SPEC_GET(DT_ALIAS(relay3), gpios),
+};
+
+struct sim_zb_callback {
+	struct k_work_delayable work;
+	zb_callback_t func;
+	zb_uint8_t param;
+	bool busy;
+};
+
+static struct sim_zb_callback zb_callbacks[SIM_ZB_CALLBACKS];
+static struct k_spinlock zb_lock;
+static struct k_work_q zboss_q;
+K_THREAD_STACK_DEFINE(zboss_stack, SIM_ZB_STACK_SIZE);
+
+static atomic_t wakeups;
+static atomic_t frames;
+
+/* Zigbee device layer state, owned by the ZBOSS and workqueue threads */
+static bool relay_state;
+static void (*relay_report_sent_cb)(bool sent);
+
+void sys_trace_idle_user(void)
+{
+	atomic_inc(&wakeups);
+}
+
+static void zb_callback_handler(struct k_work *work)
+{
+	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+	struct sim_zb_callback *cb = CONTAINER_OF(dwork, struct sim_zb_callback, work);
+	zb_callback_t func = cb->func;
+	zb_uint8_t param = cb->param;
+	k_spinlock_key_t key = k_spin_lock(&zb_lock);
+
+	cb->busy = false;
+	k_spin_unlock(&zb_lock, key);
+
+	func(param);
+}
+
+zb_ret_t sim_zb_schedule(zb_callback_t func, zb_uint8_t param, uint32_t delay_ms)
+{
+	k_spinlock_key_t key = k_spin_lock(&zb_lock);
+
+	for (int i = 0; i < SIM_ZB_CALLBACKS; i++) {
+		struct sim_zb_callback *cb = &zb_callbacks[i];
+
+		if (!cb->busy) {
+			cb->busy = true;
+			cb->func = func;
+			cb->param = param;
+			k_spin_unlock(&zb_lock, key);
+
+			k_work_schedule_for_queue(&zboss_q, &cb->work, K_MSEC(delay_ms));
+			return RET_OK;
+		}
+	}
+
+	k_spin_unlock(&zb_lock, key);
+	printk("ZBOSS stand-in: callback queue full\n");
+	return RET_OVERFLOW;
+}
+
+zb_ret_t sim_zb_cancel(zb_callback_t func, zb_uint8_t param)
+{
+	zb_ret_t ret = RET_NOT_FOUND;
+	k_spinlock_key_t key = k_spin_lock(&zb_lock);
+
+	for (int i = 0; i < SIM_ZB_CALLBACKS; i++) {
+		struct sim_zb_callback *cb = &zb_callbacks[i];
+
+		if (cb->busy && cb->func == func &&
+		    (param == ZB_ALARM_ANY_PARAM || cb->param == param)) {
+			/* Not running: ZBOSS callbacks only cancel from the
+			 * ZBOSS thread, which is this work queue
+			 */
+			k_work_cancel_delayable(&cb->work);
+			cb->busy = false;
+			ret = RET_OK;
+		}
+	}
+
+	k_spin_unlock(&zb_lock, key);
+	return ret;
+}
+
+void zb_bdb_reset_via_local_action(zb_uint8_t param)
+{
+	ARG_UNUSED(param);
+}
+
+void user_input_indicate(void)
+{
+}
+
+/* Application-originated TX, held off during coil pulses like schedule_app_tx() */
+static void app_tx_schedule(zb_callback_t cb)
+{
+	uint32_t holdoff_ms = actuation_scheduler_tx_holdoff_ms();
+
+	ZB_SCHEDULE_APP_ALARM(cb, 0, holdoff_ms ? holdoff_ms + 1 : 0);
+}
+
+static void relay_report_cb(zb_uint8_t param)
+{
+	ARG_UNUSED(param);
+
+	atomic_inc(&frames);
+	if (relay_report_sent_cb) {
+		relay_report_sent_cb(true);
+	}
+}
+
+static void battery_report_cb(zb_uint8_t param)
+{
+	ARG_UNUSED(param);
+
+	atomic_inc(&frames);
+}
+
+void zigbee_device_set_relay(bool on)
+{
+	relay_state = on;
+	actuation_request(0, on);
+}
+
+bool zigbee_device_toggle_relay(void)
+{
+	zigbee_device_set_relay(!relay_state);
+	return relay_state;
+}
+
+bool zigbee_device_report_relay(void (*sent_cb)(bool sent))
+{
+	if (!report_policy_relay()) {
+		return false;
+	}
+
+	relay_report_sent_cb = sent_cb;
+	app_tx_schedule(relay_report_cb);
+	return true;
+}
+
+bool zigbee_device_get_relay_state(void)
+{
+	return relay_state;
+}
+
+void zigbee_device_update_battery(int32_t voltage_mv)
+{
+	if (report_policy_battery((uint16_t)(voltage_mv / 10))) {
+		app_tx_schedule(battery_report_cb);
+	}
+}
+
+/* ZCL On/Off command handler of zigbee_device.c, including ZBOSS's answer */
+static void onoff_command_cb(zb_uint8_t param)
+{
+	/* Default Response */
+	atomic_inc(&frames);
+
+	relay_state = (param != 0);
+	onoff_collapse_command();
+}
+
+void sim_onoff_command(bool on)
+{
+	ZB_SCHEDULE_APP_CALLBACK(onoff_command_cb, on ? 1 : 0);
+}
+
+int sim_device_init(void)
+{
+	const struct k_work_queue_config cfg = {
+		.name = "zboss",
+	};
+
+	for (int i = 0; i < SIM_ZB_CALLBACKS; i++) {
+		k_work_init_delayable(&zb_callbacks[i].work, zb_callback_handler);
+	}
+
+	k_work_queue_start(&zboss_q, zboss_stack, K_THREAD_STACK_SIZEOF(zboss_stack),
+			   K_PRIO_PREEMPT(1), &cfg);
+
+	/* The simulated device is joined from the start */
+	report_policy_set_joined(true);
+	return 0;
+}
+
+int sim_battery_set(int32_t voltage_mv)
+{
+	/* Undo the divider described in devicetree to get the pin voltage */
+	uint32_t pin_mv = (voltage_mv * DT_PROP(VBAT_NODE, scale_divisor)) /
+			  DT_PROP(VBAT_NODE, scale_multiplier);
+
+	return adc_emul_const_value_set(adc_dev, DT_IO_CHANNELS_INPUT(VBAT_NODE), pin_mv);
+}
+
+int sim_button_set(bool pressed)
+{
+	const struct gpio_dt_spec *button = button_get_dt_spec();
+	bool active_low = (button->dt_flags & GPIO_ACTIVE_LOW) != 0;
+
+	return gpio_emul_input_set(button->port, button->pin, pressed != active_low);
+}
+
+bool sim_relay_get(uint8_t channel)
+{
+	if (channel >= ARRAY_SIZE(relays)) {
+		return false;
+	}
+
+	return gpio_emul_output_get(relays[channel].port, relays[channel].pin) == 1;
+}
+
+void sim_counts_take(struct sim_counts *counts)
+{
+	counts->wakeups = atomic_clear(&wakeups);
+	counts->frames = atomic_clear(&frames);
+}
@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @file main.c
+ * @brief Settings storage backend benchmark
+ *
+ * Replays the light switch's persistence pattern (a few bond-sized records
+ * written once, then frequent relay and config updates) through the settings
+ * subsystem on the flash simulator. Reports write and read latency, flash
+ * erase count and garbage-collection cost per BENCH_UPDATES updates.
+ * A write that erased a sector is counted as a garbage-collection event.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/stats/stats.h>
+#include <string.h>
+
+#define BENCH_UPDATES      1000
+#define BENCH_READS        100
+#define BENCH_BOND_RECORDS 8
+#define BENCH_BOND_SIZE    64
+#define BENCH_CFG_EVERY    10   /* Every Nth update writes the config record */
+
+#if defined(CONFIG_SETTINGS_ZMS)
+#define BENCH_BACKEND "zms"
+#elif defined(CONFIG_SETTINGS_NVS)
+#define BENCH_BACKEND "nvs"
+#else
+#define BENCH_BACKEND "other"
+#endif
+
+#define BENCH_PARTITION FIXED_PARTITION_ID(storage_partition)
+
+struct flash_counts {
+	uint32_t erases;
+	uint32_t writes;
+	uint32_t bytes_written;
+};
+
+struct latency {
+	uint32_t count;
+	uint32_t max_us;
+	uint64_t sum_us;
+};
+
+struct app_cfg {
+	uint32_t report_interval_s;
+	uint16_t collapse_window_ms;
+	uint8_t tx_power;
+	uint8_t flags;
+	uint8_t reserved[8];
+};
+
+static int stats_walk_cb(struct stats_hdr *hdr, void *arg, const char *name, uint16_t off)
+{
+	struct flash_counts *counts = arg;
+	uint32_t val = *(uint32_t *)((uint8_t *)hdr + off);
+
+	if (strcmp(name, "flash_erase_calls") == 0) {
+		counts->erases = val;
+	} else if (strcmp(name, "flash_write_calls") == 0) {
+		counts->writes = val;
+	} else if (strcmp(name, "bytes_written") == 0) {
+		counts->bytes_written = val;
+	}
+
+	return 0;
+}
+
+static void flash_counts_get(struct flash_counts *counts)
+{
+	struct stats_hdr *hdr = stats_group_find("flash_sim_stats");
+
+	memset(counts, 0, sizeof(*counts));
+	if (hdr) {
+		stats_walk(hdr, stats_walk_cb, counts);
+	}
+}
+
+static void latency_add(struct latency *lat, uint32_t us)
+{
+	lat->count++;
+	lat->sum_us += us;
+	lat->max_us = MAX(lat->max_us, us);
+}
+
+static uint32_t latency_avg(const struct latency *lat)
+{
+	return lat->count ? (uint32_t)(lat->sum_us / lat->count) : 0;
+}
+
+static int read_cb(const char *key, size_t len, settings_read_cb read_fn, void *cb_arg,
+		   void *param)
+{
+	uint8_t *value = param;
+
+	ARG_UNUSED(key);
+
+	return read_fn(cb_arg, value, MIN(len, sizeof(*value))) < 0 ? -EIO : 0;
+}
+
+static int erase_partition(void)
+{
+	const struct flash_area *fa;
+	int err = flash_area_open(BENCH_PARTITION, &fa);
+
+	if (err) {
+		return err;
+	}
+
+	/* The native_sim flash file persists between runs */
+	err = flash_area_erase(fa, 0, fa->fa_size);
+	printk("Storage partition: %u bytes\n", (unsigned int)fa->fa_size);
+	flash_area_close(fa);
+	return err;
+}
+
+int main(void)
+{
+	struct flash_counts before, after, start;
+	struct latency write_lat = { 0 };
+	struct latency gc_lat = { 0 };
+	struct latency read_lat = { 0 };
+	struct app_cfg cfg = { 0 };
+	uint8_t bond[BENCH_BOND_SIZE];
+	uint8_t relay = 0;
+	char key[16];
+	int err;
+
+	printk("Settings storage benchmark, backend: %s\n", BENCH_BACKEND);
+
+	err = erase_partition();
+	if (err) {
+		printk("Partition erase failed: %d\n", err);
+		return 0;
+	}
+
+	err = settings_subsys_init();
+	if (err) {
+		printk("Settings init failed: %d\n", err);
+		return 0;
+	}
+
+	/* Long-lived records, like Bluetooth bonds */
+	for (int i = 0; i < BENCH_BOND_RECORDS; i++) {
+		memset(bond, i, sizeof(bond));
+		snprintk(key, sizeof(key), "bt/bond/%d", i);
+		settings_save_one(key, bond, sizeof(bond));
+	}
+
+	flash_counts_get(&start);
+
+	for (int i = 0; i < BENCH_UPDATES; i++) {
+		uint32_t t0;
+		uint32_t us;
+
+		flash_counts_get(&before);
+		t0 = k_cycle_get_32();
+
+		if ((i % BENCH_CFG_EVERY) == BENCH_CFG_EVERY - 1) {
+			cfg.report_interval_s = i;
+			err = settings_save_one("app/cfg", &cfg, sizeof(cfg));
+		} else {
+			relay = !relay;
+			err = settings_save_one("app/relay", &relay, sizeof(relay));
+		}
+
+		us = k_cyc_to_us_floor32(k_cycle_get_32() - t0);
+		flash_counts_get(&after);
+
+		if (err) {
+			printk("Update %d failed: %d\n", i, err);
+			return 0;
+		}
+
+		latency_add(&write_lat, us);
+		if (after.erases != before.erases) {
+			latency_add(&gc_lat, us);
+		}
+	}
+
+	flash_counts_get(&after);
+
+	for (int i = 0; i < BENCH_READS; i++) {
+		uint8_t value = 0xff;
+		uint32_t t0 = k_cycle_get_32();
+
+		settings_load_subtree_direct("app/relay", read_cb, &value);
+		latency_add(&read_lat, k_cyc_to_us_floor32(k_cycle_get_32() - t0));
+	}
+
+	printk("Updates:       %d\n", BENCH_UPDATES);
+	printk("Write latency: avg %u us, max %u us\n", latency_avg(&write_lat),
+	       write_lat.max_us);
+	printk("Read latency:  avg %u us, max %u us\n", latency_avg(&read_lat),
+	       read_lat.max_us);
+	printk("Flash:         %u erases, %u writes, %u bytes\n",
+	       after.erases - start.erases, after.writes - start.writes,
+	       after.bytes_written - start.bytes_written);
+	printk("GC:            %u events, %llu us total\n", gc_lat.count, gc_lat.sum_us);
+
+	/* One machine-readable line for the twister console harness */
+	printk("BENCH_RESULT {\"backend\":\"%s\",\"updates\":%d,"
+	       "\"write_avg_us\":%u,\"write_max_us\":%u,"
+	       "\"read_avg_us\":%u,\"read_max_us\":%u,"
+	       "\"erases\":%u,\"flash_writes\":%u,\"bytes_written\":%u,"
+	       "\"gc_events\":%u,\"gc_total_us\":%llu}\n",
+	       BENCH_BACKEND, BENCH_UPDATES,
+	       latency_avg(&write_lat), write_lat.max_us,
+	       latency_avg(&read_lat), read_lat.max_us,
+	       after.erases - start.erases, after.writes - start.writes,
+	       after.bytes_written - start.bytes_written,
+	       gc_lat.count, gc_lat.sum_us);
+
+	return 0;
+}
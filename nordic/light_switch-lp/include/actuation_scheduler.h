@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @file actuation_scheduler.h
+ * @brief Staggered relay actuation under a peak battery current budget
+ *
+ * Relay coil pulses are queued per channel and started only while the coil
+ * currents in flight, the hold current of every channel driven ON and a
+ * reserved radio TX stay within CONFIG_ACTUATION_PEAK_BUDGET_MA. Radio TX
+ * that the application originates asks for a hold-off, which also reserves
+ * the TX current so no pulse starts under the frame.
+ */
+
+#ifndef ACTUATION_SCHEDULER_H
+#define ACTUATION_SCHEDULER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Actuation latency statistics
+ *
+ * Latencies have the resolution of the system timer: one 32.768 kHz RTC
+ * tick (about 30.5 us) on nRF52/nRF53.
+ */
+struct actuation_stats {
+	uint32_t actuations;      /* Coil pulses started */
+	uint32_t deferred;        /* Requests that had to wait for budget */
+	uint32_t skipped;         /* Requests already matching the relay state */
+	uint32_t latency_max_us;  /* Worst request-to-actuation latency */
+	uint32_t peak_load_ma;    /* Highest load at a pulse start */
+	uint64_t latency_sum_us;  /* Sum of latencies, for the average */
+};
+
+/**
+ * @brief Initialize the actuation scheduler
+ *
+ * Must be called after gpio_control_init(). All channels start OFF.
+ */
+void actuation_scheduler_init(void);
+
+/**
+ * @brief Request a relay channel state
+ *
+ * Actuates immediately when the budget allows, otherwise the request is
+ * queued. A newer request for the same channel replaces a queued one, so
+ * at most one request per channel waits and the added latency is bounded
+ * by channels x CONFIG_ACTUATION_PULSE_MS. A request back to the driven
+ * state cancels the queued one without a pulse. Safe to call from ISRs.
+ *
+ * @param channel Relay channel index
+ * @param on true to turn relay on, false to turn off
+ */
+void actuation_request(uint8_t channel, bool on);
+
+/**
+ * @brief Get how long application TX should be held off
+ *
+ * Reserves CONFIG_ACTUATION_TX_CURRENT_MA from now until
+ * CONFIG_ACTUATION_TX_WINDOW_MS after the hold-off; pulses requested in
+ * that time wait for the window to end. Call it once per frame.
+ *
+ * @return 0 if a radio TX fits in the current budget, otherwise the time in
+ *         milliseconds until enough coil pulses have finished
+ */
+uint32_t actuation_scheduler_tx_holdoff_ms(void);
+
+/**
+ * @brief Get actuation latency statistics
+ *
+ * @param[out] stats Statistics snapshot
+ */
+void actuation_scheduler_get_stats(struct actuation_stats *stats);
+
+/**
+ * @brief Reset actuation latency statistics
+ */
+void actuation_scheduler_reset_stats(void);
+
+#endif /* ACTUATION_SCHEDULER_H */
@@ -6,9 +6,11 @@
 
 /**
  * @file adc_reader.h
- * @brief ADC voltage reader interface for P0.04 (AIN2)
+ * @brief ADC measurement inputs described in devicetree
  *
- * Reads voltage from P0.04, calibrated for 1.5V to 3.3V range.
+ * Inputs come from the fcapps,adc-inputs devicetree node. Each child node
+ * gives the ADC channel, divider ratio, offset and unit, so adding a board
+ * needs only an overlay. The first child is the battery/supply input.
  */
 
 #ifndef ADC_READER_H
@@ -16,17 +18,27 @@
 
 #include <stdint.h>
 
+/* Index of the battery/supply input (first fcapps,adc-inputs child) */
+#define ADC_INPUT_BATTERY 0
+
 /**
- * @brief Initialize the ADC for voltage reading
+ * @brief Initialize the ADC for all devicetree inputs
  *
- * Configures ADC channel 2 (P0.04/AIN2) for voltage measurement.
+ * Configures the ADC channel of every fcapps,adc-inputs child node.
  *
  * @return 0 on success, negative error code on failure
  */
 int adc_reader_init(void);
 
 /**
- * @brief Read raw ADC value
+ * @brief Get the number of ADC inputs defined in devicetree
+ *
+ * @return Number of inputs (0 if ADC is disabled)
+ */
+int adc_input_count(void);
+
+/**
+ * @brief Read raw ADC value of the battery input
  *
  * @param[out] raw_value Pointer to store the raw 12-bit ADC value
  * @return 0 on success, negative error code on failure
@@ -34,10 +46,21 @@ int adc_reader_init(void);
 int adc_read_raw(int16_t *raw_value);
 
 /**
- * @brief Read voltage in millivolts
+ * @brief Read an input converted to its devicetree unit
+ *
+ * Averages CONFIG_ADC_OVERSAMPLE_COUNT samples, converts them to millivolts
+ * at the ADC pin and applies the input's divider ratio and offset.
+ *
+ * @param index Input index (devicetree child order)
+ * @param[out] value Pointer to store the converted value
+ * @return 0 on success, negative error code on failure
+ */
+int adc_read_input(int index, int32_t *value);
+
+/**
+ * @brief Read battery voltage in millivolts
  *
- * Converts the raw ADC reading to millivolts.
- * Valid range is approximately 0-3600mV with internal reference and 1/6 gain.
+ * Shorthand for adc_read_input(ADC_INPUT_BATTERY, ...).
  *
  * @param[out] voltage_mv Pointer to store the voltage in millivolts
  * @return 0 on success, negative error code on failure
@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @file ble_dfu.h
+ * @brief Local firmware update over BLE (mcumgr/SMP)
+ */
+
+#ifndef BLE_DFU_H
+#define BLE_DFU_H
+
+#ifdef CONFIG_BLE_SMP_DFU
+
+/**
+ * @brief Enable Bluetooth and start advertising the SMP service
+ *
+ * Advertising stops after CONFIG_BLE_SMP_DFU_ADV_WINDOW_SEC. Connected
+ * centrals are switched to 2M PHY, maximum data length and a large MTU,
+ * and must pair with the passkey before SMP accepts their requests.
+ *
+ * @return 0 on success, negative error code on failure
+ */
+int ble_dfu_init(void);
+
+#else
+
+static inline int ble_dfu_init(void)
+{
+	return 0;
+}
+
+#endif /* CONFIG_BLE_SMP_DFU */
+
+#endif /* BLE_DFU_H */
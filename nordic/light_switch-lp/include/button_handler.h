@@ -13,6 +13,26 @@
 #define BUTTON_HANDLER_H
 
 #include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Press latency statistics
+ *
+ * Measured from the first edge of the action (press edge with the fast
+ * path, release edge otherwise) to the relay actuation, and to the end of
+ * the transmission of the On/Off attribute report (APS data confirm), which
+ * is only sent with CONFIG_BUTTON_PRESS_REPORT.
+ * Resolution is one system timer tick (about 30.5 us on nRF52).
+ */
+struct button_latency_stats {
+	uint32_t presses;       /* Short presses acted upon */
+	uint32_t rollbacks;     /* Fast-path actuations undone as noise */
+	uint32_t frames;        /* On/Off reports transmitted after a press */
+	uint32_t relay_max_us;
+	uint64_t relay_sum_us;
+	uint32_t frame_max_us;  /* Press to report TX done */
+	uint64_t frame_sum_us;
+};
 
 /**
  * @brief Button event callback type
@@ -35,4 +55,16 @@ typedef void (*button_event_cb_t)(bool long_press);
  */
 int button_handler_init(button_event_cb_t callback);
 
+/**
+ * @brief Get press latency statistics
+ *
+ * @param[out] stats Statistics snapshot
+ */
+void button_handler_get_latency(struct button_latency_stats *stats);
+
+/**
+ * @brief Reset button latency statistics
+ */
+void button_handler_reset_latency(void);
+
 #endif /* BUTTON_HANDLER_H */
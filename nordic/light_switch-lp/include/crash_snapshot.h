@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @file crash_snapshot.h
+ * @brief Retained-RAM crash and reset-cause snapshot
+ *
+ * A small record lives in a devicetree retention partition and is kept up to
+ * date while the application runs. After the next reset it is read back
+ * together with the hardware reset cause and reported once over Zigbee.
+ * The same record hands the relay state across an update reboot.
+ */
+
+#ifndef CRASH_SNAPSHOT_H
+#define CRASH_SNAPSHOT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Number of trace events kept in the retained ring */
+#define CRASH_SNAPSHOT_TRACE_LEN 8
+
+/**
+ * @brief Trace event codes stored in the retained ring
+ */
+enum crash_trace_evt {
+	CRASH_TRACE_NONE = 0,
+	CRASH_TRACE_BOOT,
+	CRASH_TRACE_JOINED,
+	CRASH_TRACE_LEFT,
+	CRASH_TRACE_RELAY_ON,
+	CRASH_TRACE_RELAY_OFF,
+	CRASH_TRACE_BUTTON,
+	CRASH_TRACE_FOTA_FINISHED,
+	CRASH_TRACE_FATAL,
+	CRASH_TRACE_SMP_RESET,
+};
+
+/**
+ * @brief Boot phases timed after reset (uptime at which each is reached)
+ */
+enum boot_phase {
+	BOOT_PHASE_MAIN,           /* main() entered */
+	BOOT_PHASE_RELAY_RESTORED, /* Relay driven to its handed-over state */
+	BOOT_PHASE_STACK_STARTED,  /* zigbee_enable() called */
+	BOOT_PHASE_JOINED,         /* Network rejoined */
+	BOOT_PHASE_COUNT,
+};
+
+/**
+ * @brief Snapshot of the previous run, as seen after reset
+ */
+struct crash_snapshot_info {
+	uint32_t reset_cause;   /* hwinfo RESET_* flags (0 = power-on/brown-out) */
+	bool retained_valid;    /* false if retained RAM was lost (POR/BOR) */
+	uint32_t fault_reason;  /* K_ERR_* of a fatal error, 0 if none */
+	uint32_t fault_pc;      /* Faulting PC, 0 if none */
+	uint32_t fault_lr;      /* LR at fault, 0 if none */
+	uint16_t battery_mv;    /* Last battery voltage measured before reset */
+	uint32_t uptime_s;      /* Uptime at the last record update before reset */
+	bool update_reboot;     /* Previous run rebooted to apply an update */
+	uint8_t trace[CRASH_SNAPSHOT_TRACE_LEN]; /* Oldest first */
+};
+
+#ifdef CONFIG_CRASH_SNAPSHOT
+
+/**
+ * @brief Read back the previous run's record and start a fresh one
+ *
+ * Must be called first thing in main(), before anything can fault.
+ */
+void crash_snapshot_init(void);
+
+/**
+ * @brief Append an event to the retained trace ring
+ *
+ * @param evt Event code
+ */
+void crash_snapshot_trace(enum crash_trace_evt evt);
+
+/**
+ * @brief Record the latest battery voltage in the retained record
+ *
+ * @param voltage_mv Battery voltage in millivolts
+ */
+void crash_snapshot_set_battery(int32_t voltage_mv);
+
+/**
+ * @brief Take the previous run's snapshot for reporting
+ *
+ * Returns true only once per boot, so the snapshot is reported a single time.
+ *
+ * @param[out] info Snapshot of the previous run
+ * @return true if a snapshot is pending report, false otherwise
+ */
+bool crash_snapshot_take(struct crash_snapshot_info *info);
+
+/**
+ * @brief Hand the relay state over to the next boot
+ *
+ * Called right before an update reboot so the relay is driven back to the
+ * same state as soon as the new image starts instead of the power-on default
+ * (OFF). The relay output is not driven while MCUboot runs.
+ *
+ * @param on Relay state to restore after reboot
+ */
+void crash_snapshot_set_relay_handover(bool on);
+
+/**
+ * @brief Withdraw a relay handover set in this run
+ *
+ * Called when an update is abandoned, so the next ordinary reset does not
+ * pass for an update reboot.
+ */
+void crash_snapshot_clear_relay_handover(void);
+
+/**
+ * @brief Take the relay state handed over by the previous run
+ *
+ * @param[out] on Relay state to restore
+ * @return true if a handover was pending, false otherwise
+ */
+bool crash_snapshot_take_relay_handover(bool *on);
+
+/**
+ * @brief Record that a boot phase has been reached
+ *
+ * Only the first call per phase counts. When the network is rejoined after
+ * an update reboot, all phase times are logged.
+ *
+ * @param phase Boot phase reached
+ */
+void crash_snapshot_boot_phase(enum boot_phase phase);
+
+/**
+ * @brief Get the uptime at which a boot phase was reached
+ *
+ * @param phase Boot phase
+ * @return Uptime in milliseconds, 0 if not reached yet
+ */
+uint32_t crash_snapshot_boot_phase_ms(enum boot_phase phase);
+
+#else
+
+static inline void crash_snapshot_init(void)
+{
+}
+
+static inline void crash_snapshot_trace(enum crash_trace_evt evt)
+{
+	(void)evt;
+}
+
+static inline void crash_snapshot_set_battery(int32_t voltage_mv)
+{
+	(void)voltage_mv;
+}
+
+static inline bool crash_snapshot_take(struct crash_snapshot_info *info)
+{
+	(void)info;
+	return false;
+}
+
+static inline void crash_snapshot_set_relay_handover(bool on)
+{
+	(void)on;
+}
+
+static inline void crash_snapshot_clear_relay_handover(void)
+{
+}
+
+static inline bool crash_snapshot_take_relay_handover(bool *on)
+{
+	(void)on;
+	return false;
+}
+
+static inline void crash_snapshot_boot_phase(enum boot_phase phase)
+{
+	(void)phase;
+}
+
+static inline uint32_t crash_snapshot_boot_phase_ms(enum boot_phase phase)
+{
+	(void)phase;
+	return 0;
+}
+
+#endif /* CONFIG_CRASH_SNAPSHOT */
+
+#endif /* CRASH_SNAPSHOT_H */
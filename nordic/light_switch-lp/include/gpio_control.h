@@ -13,6 +13,7 @@
 #define GPIO_CONTROL_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
 /**
  * @brief Initialize all GPIO pins (relay, MOSFET, LEDs, and button)
@@ -34,12 +35,31 @@ void led_power_set(bool on);
 /**
  * @brief Set the relay state
  *
- * Controls the relay output on P0.29 (active high).
+ * Controls relay channel 0 (P0.29 on Pro Micro, active high).
  *
  * @param on true to turn relay on, false to turn off
  */
 void relay_control_set(bool on);
 
+/**
+ * @brief Set the state of one relay channel
+ *
+ * Channel N is driven by the `relayN` devicetree alias. Out-of-range
+ * channels are ignored. Application code should go through the actuation
+ * scheduler rather than calling this directly.
+ *
+ * @param channel Relay channel index
+ * @param on true to turn relay on, false to turn off
+ */
+void relay_control_set_channel(uint8_t channel, bool on);
+
+/**
+ * @brief Get the number of relay channels defined in devicetree
+ *
+ * @return Number of relay channels (0 if none)
+ */
+uint8_t relay_channel_count(void);
+
 #ifndef CONFIG_DK_LIBRARY
 /**
  * @brief Get current button state
@@ -0,0 +1,30 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @file onoff_collapse.h
+ * @brief Collapse bursts of On/Off commands to one relay actuation
+ *
+ * A sleepy end device receives the commands queued at its parent in one
+ * poll or over several. Each command updates the relay state right away
+ * (last writer wins), but the relay is only driven once the burst is over.
+ */
+
+#ifndef ONOFF_COLLAPSE_H
+#define ONOFF_COLLAPSE_H
+
+/**
+ * @brief Account for an On/Off command received for the relay
+ *
+ * Must be called in ZBOSS context after the new state is visible through
+ * zigbee_device_get_relay_state(). Each command (re)arms a commit
+ * CONFIG_ONOFF_COLLAPSE_WINDOW_MS later, but no later than
+ * CONFIG_ONOFF_COLLAPSE_MAX_MS after the first command of the burst. The
+ * commit drives the relay to the state current at that time.
+ */
+void onoff_collapse_command(void);
+
+#endif /* ONOFF_COLLAPSE_H */
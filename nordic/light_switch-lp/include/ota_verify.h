@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @file ota_verify.h
+ * @brief Streaming verification of Zigbee OTA images
+ *
+ * Every OTA block is parsed and hashed (SHA-256) before it is handed to the
+ * Zigbee FOTA library, following the OTA file header, the upgrade image
+ * sub-element and the MCUboot image header. At the OTA check step the digest
+ * is compared with the image's SHA-256 TLV, so a corrupt transfer is
+ * rejected before the reboot instead of by MCUboot after it. Malformed
+ * headers are rejected as soon as they arrive.
+ */
+
+#ifndef OTA_VERIFY_H
+#define OTA_VERIFY_H
+
+#include <stdbool.h>
+#include <zboss_api.h>
+
+#ifdef CONFIG_OTA_STREAM_VERIFY
+
+/**
+ * @brief Initialize the verifier
+ *
+ * @return 0 on success, negative error code on failure
+ */
+int ota_verify_init(void);
+
+/**
+ * @brief Inspect an OTA upgrade value callback before the FOTA library
+ *
+ * Call for every ZB_ZCL_OTA_UPGRADE_VALUE_CB_ID callback, before
+ * zigbee_fota_zcl_cb(). On rejection the upgrade status is already set to
+ * ZB_ZCL_OTA_UPGRADE_STATUS_ERROR; the caller must not forward the callback
+ * and should abort the FOTA transfer.
+ *
+ * @param value OTA upgrade value parameter of the callback
+ * @return true to forward the callback, false if the image was rejected
+ */
+bool ota_verify_value_cb(zb_zcl_ota_upgrade_value_param_t *value);
+
+#else
+
+static inline int ota_verify_init(void)
+{
+	return 0;
+}
+
+static inline bool ota_verify_value_cb(zb_zcl_ota_upgrade_value_param_t *value)
+{
+	(void)value;
+	return true;
+}
+
+#endif /* CONFIG_OTA_STREAM_VERIFY */
+
+#endif /* OTA_VERIFY_H */
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @file perf_counters.h
+ * @brief Development performance counters and the "perf" shell group
+ *
+ * Counters and latency histograms are updated through the PERF_COUNT() and
+ * PERF_HIST() macros, which expand to nothing unless
+ * CONFIG_APP_PERF_COUNTERS is enabled, so low-power builds carry no code
+ * or RAM for them.
+ */
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdint.h>
+
+/**
+ * @brief Event counters
+ */
+enum perf_counter {
+	PERF_WAKE_BUTTON,        /* Button GPIO edge woke the CPU */
+	PERF_WAKE_ADC,           /* Periodic ADC work ran */
+	PERF_WAKE_ZBOSS,         /* ZBOSS went to sleep (one per poll/alarm wake-up) */
+	PERF_WAKE_ACTUATION,     /* Deferred actuation dispatch ran */
+	PERF_ISR_BUTTON,         /* Button edge interrupts */
+	PERF_ISR_DEBOUNCE,       /* Debounce timer expiries */
+	PERF_CMD_ONOFF,          /* On/Off commands received */
+	PERF_REPORT_BATTERY,     /* Battery reports sent */
+	PERF_REPORT_RELAY,       /* On/Off reports sent after a button press */
+	PERF_ZBOSS_NO_BUF,       /* Reports that found no free ZBOSS buffer */
+	PERF_REPORT_RESET_DIAG,  /* Reset diagnostics reports sent */
+	PERF_ADC_CONVERSION,     /* ADC conversions (each oversample counts) */
+	PERF_COUNTER_COUNT,
+};
+
+/**
+ * @brief Latency histograms (log2 buckets in microseconds)
+ */
+enum perf_hist {
+	PERF_HIST_ACTUATION_US,  /* Actuation request to coil pulse */
+	PERF_HIST_PRESS_US,      /* Button press to relay */
+	PERF_HIST_COUNT,
+};
+
+#ifdef CONFIG_APP_PERF_COUNTERS
+
+/**
+ * @brief Increment an event counter. Safe to call from ISRs.
+ *
+ * @param counter Counter to increment
+ */
+void perf_counter_inc(enum perf_counter counter);
+
+/**
+ * @brief Record a sample in a latency histogram. Safe to call from ISRs.
+ *
+ * @param hist Histogram
+ * @param value_us Sample in microseconds
+ */
+void perf_hist_record(enum perf_hist hist, uint32_t value_us);
+
+/**
+ * @brief Read an event counter
+ *
+ * @param counter Counter to read
+ * @return Count since boot or the last reset
+ */
+uint32_t perf_counter_get(enum perf_counter counter);
+
+/**
+ * @brief Reset all event counters and latency histograms
+ */
+void perf_counters_reset(void);
+
+#define PERF_COUNT(name) perf_counter_inc(PERF_##name)
+#define PERF_HIST(name, value_us) perf_hist_record(PERF_HIST_##name, (value_us))
+
+#else
+
+#define PERF_COUNT(name) do { } while (0)
+#define PERF_HIST(name, value_us) do { (void)(value_us); } while (0)
+
+#endif /* CONFIG_APP_PERF_COUNTERS */
+
+#endif /* PERF_COUNTERS_H */
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @file report_policy.h
+ * @brief Decisions on which attribute reports the device sends
+ *
+ * Kept free of ZBOSS so the scenario benchmark counts frames from the same
+ * decisions as zigbee_device.c.
+ */
+
+#ifndef REPORT_POLICY_H
+#define REPORT_POLICY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Record whether the device is joined to a network
+ *
+ * No report is sent while the device is not joined.
+ *
+ * @param joined true once joined, false after leaving
+ */
+void report_policy_set_joined(bool joined);
+
+/**
+ * @brief Check whether the device is joined to a network
+ *
+ * @return true if joined, false otherwise
+ */
+bool report_policy_joined(void);
+
+/**
+ * @brief Decide whether an On/Off attribute report can be sent now
+ *
+ * @return true to send the report, false otherwise
+ */
+bool report_policy_relay(void);
+
+/**
+ * @brief Decide whether a battery reading is reported
+ *
+ * A reading is reported when it differs from the last reported one by at
+ * least 50 mV. It then becomes the last reported value even when the device
+ * is not joined, so a rejoin does not resend an old change.
+ *
+ * @param voltage_10mv Battery voltage in 10 mV units
+ * @return true to send a battery report, false otherwise
+ */
+bool report_policy_battery(uint16_t voltage_10mv);
+
+#endif /* REPORT_POLICY_H */
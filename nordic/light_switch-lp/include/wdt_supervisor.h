@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @file wdt_supervisor.h
+ * @brief Sleep-aware watchdog supervisor
+ *
+ * The hardware watchdog is only fed once every expected application context
+ * has reported liveness since the previous feed. Contexts report from wake-ups
+ * that already happen (Zigbee polls, ADC work, button work), so supervision
+ * never adds a timer wake-up of its own.
+ */
+
+#ifndef WDT_SUPERVISOR_H
+#define WDT_SUPERVISOR_H
+
+/**
+ * @brief Application contexts supervised by the watchdog
+ *
+ * Each context owns one bit in the liveness bitmap.
+ */
+enum wdt_ctx {
+	WDT_CTX_ZBOSS,      /* ZBOSS thread (scheduler callbacks, signal handler) */
+	WDT_CTX_WORKQUEUE,  /* System workqueue (ADC work, button work) */
+	WDT_CTX_COUNT,
+};
+
+#ifdef CONFIG_WDT_SUPERVISOR
+
+/**
+ * @brief Install the watchdog timeout and start the watchdog
+ *
+ * The timeout is CONFIG_WDT_SUPERVISOR_TIMEOUT_SEC and keeps running while
+ * the CPU sleeps, so a context that never wakes up again is still caught.
+ *
+ * @return 0 on success, negative error code on failure
+ */
+int wdt_supervisor_init(void);
+
+/**
+ * @brief Require a context to report liveness before each watchdog feed
+ *
+ * @param ctx Context that is expected to call wdt_supervisor_checkin()
+ */
+void wdt_supervisor_expect(enum wdt_ctx ctx);
+
+/**
+ * @brief Report liveness of a context
+ *
+ * Feeds the watchdog once all expected contexts have checked in.
+ * Safe to call from any context, including ISRs.
+ *
+ * @param ctx Context reporting liveness
+ */
+void wdt_supervisor_checkin(enum wdt_ctx ctx);
+
+/**
+ * @brief Check in the ZBOSS context through the ZBOSS scheduler
+ *
+ * Schedules an app callback that checks in WDT_CTX_ZBOSS, proving the ZBOSS
+ * thread still runs scheduled callbacks. Called from the periodic ADC work
+ * so non-sleepy builds, which never see the can-sleep signal, are covered.
+ */
+void wdt_supervisor_probe_zboss(void);
+
+#else
+
+static inline int wdt_supervisor_init(void)
+{
+	return 0;
+}
+
+static inline void wdt_supervisor_expect(enum wdt_ctx ctx)
+{
+	(void)ctx;
+}
+
+static inline void wdt_supervisor_checkin(enum wdt_ctx ctx)
+{
+	(void)ctx;
+}
+
+static inline void wdt_supervisor_probe_zboss(void)
+{
+}
+
+#endif /* CONFIG_WDT_SUPERVISOR */
+
+#endif /* WDT_SUPERVISOR_H */
@@ -8,6 +8,19 @@
 #define ZB_MEM_CONFIG_CUSTOM_H 1
 
 
+#ifdef CONFIG_ZIGBEE_ROLE_ROUTER
+/**
+ * Mains-powered router: neighbour and routing tables sized for a larger
+ * mesh, and room for sleepy children and their indirect queues.
+ */
+#define ZB_CONFIG_ROLE_ZR
+#define ZB_CONFIG_OVERALL_NETWORK_SIZE 128
+
+/**
+ * Routing for the mesh and buffering for the children's indirect traffic.
+ */
+#define ZB_CONFIG_HIGH_TRAFFIC
+#else
 #define ZB_CONFIG_ROLE_ZED
 #define ZB_CONFIG_OVERALL_NETWORK_SIZE 16
 
@@ -15,6 +28,7 @@
  * Light routing and application traffic from/to that device.
  */
 #define ZB_CONFIG_LIGHT_TRAFFIC
+#endif /* CONFIG_ZIGBEE_ROLE_ROUTER */
 
 /**
  * Simple user's application at that device: not too many relations
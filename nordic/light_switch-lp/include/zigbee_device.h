@@ -23,6 +23,15 @@
  */
 #define ERASE_PERSISTENT_CONFIG    ZB_FALSE
 
+/**
+ * @brief Restore the relay state after reset
+ *
+ * Drives the relay to the state handed over through retained RAM by an
+ * update reboot, or OFF after any other reset. Call as early as possible
+ * after gpio_control_init() to keep the load outage short.
+ */
+void zigbee_device_restore_relay(void);
+
 /**
  * @brief Initialize Zigbee device clusters and attributes
  *
@@ -51,6 +60,21 @@ void zigbee_device_set_relay(bool on);
  */
 bool zigbee_device_toggle_relay(void);
 
+/**
+ * @brief Report the relay On/Off attribute to the coordinator
+ *
+ * The relay endpoint has no reporting context, so local changes are
+ * reported explicitly. Like the battery report, the frame is held off while
+ * coil pulses leave no current headroom for the radio.
+ *
+ * @param sent_cb Called in ZBOSS context when the transmission has completed
+ *                (APS data confirm) with true, or with false if the frame
+ *                could not be sent. Can be NULL.
+ * @return true if the report was scheduled, false if not joined (sent_cb is
+ *         then not called)
+ */
+bool zigbee_device_report_relay(void (*sent_cb)(bool sent));
+
 /**
  * @brief Get current relay state
  *
@@ -31,4 +31,26 @@ void zigbee_handlers_init(void);
  */
 void identify_cb(zb_bufid_t bufid);
 
+#ifdef CONFIG_ZIGBEE_FOTA
+/**
+ * @brief Track the OTA transfer from the OTA upgrade value callback
+ *
+ * Starts the transfer timer when the OTA client starts the download, so
+ * the logged duration and throughput cover the whole transfer.
+ *
+ * @param value OTA upgrade value parameter of the callback
+ */
+void zigbee_handlers_ota_value_cb(const zb_zcl_ota_upgrade_value_param_t *value);
+
+/**
+ * @brief Clear the OTA transfer state when the application aborts it
+ *
+ * Call when the transfer is aborted without the FOTA library reporting an
+ * error, e.g. when the image is rejected while downloading. Stops the
+ * transfer timer and withdraws any relay handover.
+ */
+void zigbee_handlers_ota_abort(void);
+#endif
+
+
 #endif /* ZIGBEE_HANDLERS_H */
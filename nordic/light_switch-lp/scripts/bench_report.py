@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2020 Nordic Semiconductor ASA
+#
+# SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+#
+
+"""Collect benchmark and footprint results from a twister run into one report.
+
+Scans a twister output directory for BENCH_RESULT lines in handler.log files
+(scenario and settings storage benchmarks) and for footprint.json files
+written by the application build, and writes them to one JSON report keyed
+by platform and test name, tagged with the git revision so results can be tracked over
+time.
+"""
+
+import argparse
+import datetime
+import json
+import pathlib
+import subprocess
+import sys
+
+RESULT_TAG = 'BENCH_RESULT '
+
+
+def git_revision(path):
+    try:
+        return subprocess.check_output(['git', 'describe', '--always', '--dirty'],
+                                       cwd=path, text=True).strip()
+    except (OSError, subprocess.CalledProcessError):
+        return None
+
+
+def test_dir(path, root):
+    """Twister's per-test directory (it holds build.log) above a build output."""
+    for parent in path.parents:
+        if parent == root:
+            break
+        if (parent / 'build.log').exists():
+            return parent
+    return path.parent
+
+
+def test_key(path, root):
+    # <platform>/.../<test name>, so variants on several boards stay apart
+    return str(test_dir(path, root).relative_to(root))
+
+
+def collect(root):
+    benchmarks = {}
+    footprints = {}
+
+    for log in root.rglob('handler.log'):
+        for line in log.read_text(errors='replace').splitlines():
+            line = line.strip()
+            if line.startswith(RESULT_TAG):
+                benchmarks[test_key(log, root)] = json.loads(line[len(RESULT_TAG):])
+
+    for footprint in root.rglob('footprint.json'):
+        footprints[test_key(footprint, root)] = json.loads(footprint.read_text())
+
+    return benchmarks, footprints
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('--twister-out', default='twister-out', type=pathlib.Path)
+    parser.add_argument('--output', default='bench_report.json', type=pathlib.Path)
+    args = parser.parse_args()
+
+    if not args.twister_out.is_dir():
+        print(f'error: {args.twister_out} is not a directory', file=sys.stderr)
+        return 1
+
+    benchmarks, footprints = collect(args.twister_out)
+
+    report = {
+        'timestamp': datetime.datetime.now(datetime.timezone.utc).isoformat(),
+        'revision': git_revision(pathlib.Path(__file__).parent),
+        'benchmarks': benchmarks,
+        'footprints': footprints,
+    }
+
+    args.output.write_text(json.dumps(report, indent=2) + '\n')
+
+    failed = [name for name, result in footprints.items() if not result.get('pass', True)]
+    failed += [f"{name}/{s['name']}" for name, result in benchmarks.items()
+               for s in result.get('scenarios', []) if not s.get('pass', True)]
+
+    print(f'{len(benchmarks)} benchmark(s), {len(footprints)} footprint(s) -> {args.output}')
+    for name in failed:
+        print(f'over budget: {name}')
+
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
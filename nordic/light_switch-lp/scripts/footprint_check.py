@@ -0,0 +1,128 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2020 Nordic Semiconductor ASA
+#
+# SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+#
+
+"""Check the ROM/RAM footprint of a build against its budgets.
+
+Reads the linked ELF, writes footprint.json and exits non-zero when a budget
+is exceeded. A budget of 0 only reports. On parts where unused RAM sections
+are powered down at run time, the number of sections the image keeps powered
+is reported too, since crossing a section boundary costs sleep current.
+"""
+
+import argparse
+import json
+import sys
+
+from elftools.elf.constants import SH_FLAGS
+from elftools.elf.elffile import ELFFile
+from elftools.elf.sections import SymbolTableSection
+
+
+def parse_sections(spec):
+    """Parse a RAM section layout such as "4096*16,32768*6"."""
+    sizes = []
+    for part in spec.split(','):
+        size, _, count = part.partition('*')
+        sizes += [int(size, 0)] * int(count or 1, 0)
+    return sizes
+
+
+def symbol_value(elf, name):
+    for section in elf.iter_sections():
+        if isinstance(section, SymbolTableSection):
+            symbols = section.get_symbol_by_name(name)
+            if symbols:
+                return symbols[0]['st_value']
+    return None
+
+
+def measure(elf):
+    rom = 0
+    ram = 0
+
+    for section in elf.iter_sections():
+        flags = section['sh_flags']
+        if not flags & SH_FLAGS.SHF_ALLOC or section['sh_size'] == 0:
+            continue
+        if section['sh_type'] != 'SHT_NOBITS':
+            # Code, constants and the load image of initialized data
+            rom += section['sh_size']
+        if flags & SH_FLAGS.SHF_WRITE:
+            ram += section['sh_size']
+
+    return rom, ram
+
+
+def sections_powered(ram_start, ram_end, sizes):
+    """Number of RAM sections, from the bottom, that hold the image."""
+    addr = ram_start
+    for index, size in enumerate(sizes):
+        addr += size
+        if ram_end <= addr:
+            return index + 1
+    return len(sizes)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('--elf', required=True)
+    parser.add_argument('--output', required=True)
+    parser.add_argument('--variant', default='')
+    parser.add_argument('--rom-budget', type=int, default=0)
+    parser.add_argument('--ram-budget', type=int, default=0)
+    parser.add_argument('--ram-sections', default='',
+                        help='RAM section sizes from the RAM base, e.g. 4096*16,32768*6')
+    parser.add_argument('--ram-sections-budget', type=int, default=0)
+    args = parser.parse_args()
+
+    with open(args.elf, 'rb') as f:
+        elf = ELFFile(f)
+        rom, ram = measure(elf)
+        ram_start = symbol_value(elf, '_image_ram_start')
+        ram_end = symbol_value(elf, '_image_ram_end')
+
+    report = {
+        'variant': args.variant,
+        'rom_bytes': rom,
+        'ram_bytes': ram,
+        'rom_budget': args.rom_budget,
+        'ram_budget': args.ram_budget,
+    }
+
+    if args.ram_sections and ram_start is not None and ram_end is not None:
+        report['ram_sections_powered'] = sections_powered(
+            ram_start, ram_end, parse_sections(args.ram_sections))
+        report['ram_sections_budget'] = args.ram_sections_budget
+
+    failures = []
+    if args.rom_budget and rom > args.rom_budget:
+        failures.append(f'ROM {rom} B exceeds budget {args.rom_budget} B')
+    if args.ram_budget and ram > args.ram_budget:
+        failures.append(f'RAM {ram} B exceeds budget {args.ram_budget} B')
+    if (args.ram_sections_budget and
+            report.get('ram_sections_powered', 0) > args.ram_sections_budget):
+        failures.append(f"RAM keeps {report['ram_sections_powered']} sections powered, "
+                        f'budget {args.ram_sections_budget}')
+
+    report['pass'] = not failures
+
+    with open(args.output, 'w') as f:
+        json.dump(report, f, indent=2)
+        f.write('\n')
+
+    print(f'Footprint {args.variant}: ROM {rom} B, RAM {ram} B'
+          + (f", {report['ram_sections_powered']} RAM sections powered"
+             if 'ram_sections_powered' in report else ''))
+
+    for failure in failures:
+        print(f'error: footprint budget: {failure}', file=sys.stderr)
+
+    return 1 if failures else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
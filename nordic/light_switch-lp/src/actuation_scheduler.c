@@ -0,0 +1,270 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @file actuation_scheduler.c
+ * @brief Staggered relay actuation under a peak battery current budget
+ *
+ * Each channel has one pending slot (last writer wins) and one in-flight
+ * pulse end time. The load is the coil current of pulses in flight, the
+ * hold current of every other channel driven ON and the TX current while
+ * an application frame is reserved. A request is dispatched straight from
+ * the caller when the budget has room, so the single-relay case adds no
+ * latency. Otherwise a delayable work item dispatches it when the earliest
+ * pulse or TX window ends.
+ *
+ * Latency is timed with k_cycle_get_32(). On nRF52/nRF53 the system timer
+ * is the 32.768 kHz RTC, so the microsecond figures have a resolution of
+ * one RTC tick (about 30.5 us); an immediate dispatch reads as 0 us.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/spinlock.h>
+#include <string.h>
+
+#include "actuation_scheduler.h"
+#include "gpio_control.h"
+#include "perf_counters.h"
+
+LOG_MODULE_REGISTER(actuation, LOG_LEVEL_INF);
+
+#define ACTUATION_MAX_CHANNELS 4
+
+BUILD_ASSERT(CONFIG_ACTUATION_COIL_CURRENT_MA <= CONFIG_ACTUATION_PEAK_BUDGET_MA,
+	     "A single coil pulse must fit in the peak current budget");
+
+BUILD_ASSERT(CONFIG_ACTUATION_HOLD_CURRENT_MA <= CONFIG_ACTUATION_COIL_CURRENT_MA,
+	     "A coil cannot hold with more current than it pulls in with");
+
+struct channel_ctx {
+	bool state;          /* Last state driven to the relay */
+	bool pending;        /* A request is waiting for budget */
+	bool pending_on;     /* Requested state of the waiting request */
+	bool pulsing;        /* Coil pulse in flight */
+	uint32_t pending_cyc; /* System timer cycles when the request was queued */
+	int64_t pulse_end_ms; /* When the in-flight pulse stops drawing current */
+};
+
+static struct channel_ctx channels[ACTUATION_MAX_CHANNELS];
+static uint8_t channel_count;
+static uint8_t next_channel;  /* Round-robin start for fairness */
+static struct actuation_stats stats;
+static struct k_spinlock lock;
+static struct k_work_delayable dispatch_work;
+static int64_t tx_end_ms;  /* End of the reserved application TX window */
+
+/* Current one channel draws: coil pulse, hold current while ON, or none */
+static uint32_t channel_load_ma(const struct channel_ctx *c)
+{
+	if (c->pulsing) {
+		return CONFIG_ACTUATION_COIL_CURRENT_MA;
+	}
+
+	return c->state ? CONFIG_ACTUATION_HOLD_CURRENT_MA : 0;
+}
+
+/* Total load now. Retires finished pulses; called with lock held. */
+static uint32_t load_ma(int64_t now)
+{
+	uint32_t load = 0;
+
+	for (uint8_t i = 0; i < channel_count; i++) {
+		if (channels[i].pulsing && channels[i].pulse_end_ms <= now) {
+			channels[i].pulsing = false;
+		}
+		load += channel_load_ma(&channels[i]);
+	}
+
+	if (tx_end_ms > now) {
+		load += CONFIG_ACTUATION_TX_CURRENT_MA;
+	}
+
+	return load;
+}
+
+/* Earliest end of an in-flight pulse or the TX window, or 0 if none */
+static int64_t earliest_release(int64_t now)
+{
+	int64_t end = (tx_end_ms > now) ? tx_end_ms : 0;
+
+	for (uint8_t i = 0; i < channel_count; i++) {
+		if (channels[i].pulsing && (end == 0 || channels[i].pulse_end_ms < end)) {
+			end = channels[i].pulse_end_ms;
+		}
+	}
+
+	return end;
+}
+
+/* Start as many pending pulses as the budget allows. Called with lock held.
+ * Returns the delay until the next dispatch is needed, or K_FOREVER.
+ */
+static k_timeout_t dispatch_locked(void)
+{
+	int64_t now = k_uptime_get();
+	uint32_t load = load_ma(now);
+	uint8_t start = next_channel;
+	bool waiting = false;
+
+	for (uint8_t n = 0; n < channel_count; n++) {
+		uint8_t ch = (start + n) % channel_count;
+		struct channel_ctx *c = &channels[ch];
+
+		if (!c->pending) {
+			continue;
+		}
+
+		uint32_t new_load = load - channel_load_ma(c) + CONFIG_ACTUATION_COIL_CURRENT_MA;
+
+		if (new_load > CONFIG_ACTUATION_PEAK_BUDGET_MA) {
+			if (earliest_release(now) != 0) {
+				waiting = true;
+				continue;
+			}
+			/* Only hold currents are left and no release will make
+			 * room: waiting would starve the request.
+			 */
+			LOG_WRN("Relay %d pulse at %u mA exceeds the %d mA budget", ch,
+				new_load, CONFIG_ACTUATION_PEAK_BUDGET_MA);
+		}
+
+		uint32_t latency_us = k_cyc_to_us_floor32(k_cycle_get_32() - c->pending_cyc);
+
+		relay_control_set_channel(ch, c->pending_on);
+		c->state = c->pending_on;
+		c->pending = false;
+		c->pulsing = true;
+		c->pulse_end_ms = now + CONFIG_ACTUATION_PULSE_MS;
+		load = new_load;
+
+		stats.actuations++;
+		stats.peak_load_ma = MAX(stats.peak_load_ma, new_load);
+		stats.latency_sum_us += latency_us;
+		stats.latency_max_us = MAX(stats.latency_max_us, latency_us);
+		PERF_HIST(ACTUATION_US, latency_us);
+		next_channel = (ch + 1) % channel_count;
+
+		LOG_DBG("Relay %d %s after %u us", ch, c->state ? "ON" : "OFF", latency_us);
+	}
+
+	if (!waiting) {
+		return K_FOREVER;
+	}
+
+	return K_MSEC(MAX(earliest_release(now) - now, 1));
+}
+
+static void dispatch_work_handler(struct k_work *work)
+{
+	ARG_UNUSED(work);
+	PERF_COUNT(WAKE_ACTUATION);
+
+	k_spinlock_key_t key = k_spin_lock(&lock);
+	k_timeout_t next = dispatch_locked();
+
+	k_spin_unlock(&lock, key);
+
+	if (!K_TIMEOUT_EQ(next, K_FOREVER)) {
+		k_work_reschedule(&dispatch_work, next);
+	}
+}
+
+void actuation_scheduler_init(void)
+{
+	channel_count = MIN(relay_channel_count(), ACTUATION_MAX_CHANNELS);
+	k_work_init_delayable(&dispatch_work, dispatch_work_handler);
+
+	LOG_INF("Actuation scheduler: %d channel(s), coil %d/hold %d mA, budget %d mA, "
+		"pulse %d ms", channel_count, CONFIG_ACTUATION_COIL_CURRENT_MA,
+		CONFIG_ACTUATION_HOLD_CURRENT_MA, CONFIG_ACTUATION_PEAK_BUDGET_MA,
+		CONFIG_ACTUATION_PULSE_MS);
+
+	if (channel_count > 0 &&
+	    CONFIG_ACTUATION_COIL_CURRENT_MA + (channel_count - 1) * CONFIG_ACTUATION_HOLD_CURRENT_MA >
+	    CONFIG_ACTUATION_PEAK_BUDGET_MA) {
+		LOG_WRN("Hold currents of %d channels leave no room for a pulse in the budget",
+			channel_count - 1);
+	}
+}
+
+void actuation_request(uint8_t channel, bool on)
+{
+	if (channel >= channel_count) {
+		return;
+	}
+
+	k_spinlock_key_t key = k_spin_lock(&lock);
+	struct channel_ctx *c = &channels[channel];
+
+	if (c->state == on) {
+		/* Already there - no coil pulse needed. A waiting request for the
+		 * other state has been overridden back, so drop it as well.
+		 */
+		c->pending = false;
+		stats.skipped++;
+		k_spin_unlock(&lock, key);
+		return;
+	}
+
+	if (!c->pending) {
+		c->pending_cyc = k_cycle_get_32();
+	}
+	c->pending = true;
+	c->pending_on = on;
+
+	k_timeout_t next = dispatch_locked();
+
+	if (c->pending) {
+		stats.deferred++;
+	}
+
+	k_spin_unlock(&lock, key);
+
+	if (!K_TIMEOUT_EQ(next, K_FOREVER)) {
+		k_work_reschedule(&dispatch_work, next);
+	}
+}
+
+uint32_t actuation_scheduler_tx_holdoff_ms(void)
+{
+	uint32_t holdoff = 0;
+	k_spinlock_key_t key = k_spin_lock(&lock);
+	int64_t now = k_uptime_get();
+
+	if (load_ma(now) + CONFIG_ACTUATION_TX_CURRENT_MA > CONFIG_ACTUATION_PEAK_BUDGET_MA) {
+		/* Conservative: wait for the last in-flight pulse, pulses are short */
+		for (uint8_t i = 0; i < channel_count; i++) {
+			if (channels[i].pulsing) {
+				holdoff = MAX(holdoff, (uint32_t)(channels[i].pulse_end_ms - now));
+			}
+		}
+	}
+
+	/* Keep the radio's current reserved until the frame is out, so no
+	 * coil pulse starts under it
+	 */
+	tx_end_ms = MAX(tx_end_ms, now + holdoff + CONFIG_ACTUATION_TX_WINDOW_MS);
+
+	k_spin_unlock(&lock, key);
+	return holdoff;
+}
+
+void actuation_scheduler_get_stats(struct actuation_stats *out)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	*out = stats;
+	k_spin_unlock(&lock, key);
+}
+
+void actuation_scheduler_reset_stats(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	memset(&stats, 0, sizeof(stats));
+	k_spin_unlock(&lock, key);
+}
@@ -6,7 +6,11 @@
 
 /**
  * @file adc_reader.c
- * @brief ADC voltage reader implementation for P0.04 (AIN2)
+ * @brief ADC measurement inputs described in devicetree
+ *
+ * Every input carries its own divider ratio, offset and unit in devicetree
+ * (fcapps,adc-inputs). The ratio is folded into a Q16 fixed-point factor at
+ * build time, so one conversion path serves every board.
  */
 
 #include <zephyr/kernel.h>
@@ -17,6 +21,8 @@
 
 #include "adc_reader.h"
 #include "zigbee_device.h"
+#include "wdt_supervisor.h"
+#include "perf_counters.h"
 
 LOG_MODULE_REGISTER(adc_reader, LOG_LEVEL_INF);
 
@@ -30,16 +36,39 @@ LOG_MODULE_REGISTER(adc_reader, LOG_LEVEL_INF);
 /* Oversampling configuration for noise reduction */
 #define ADC_SAMPLE_DELAY_US     100     /* Delay between samples in microseconds */
 
-#if !DT_NODE_EXISTS(DT_PATH(zephyr_user)) || \
-    !DT_NODE_HAS_PROP(DT_PATH(zephyr_user), io_channels)
-#error "No suitable devicetree overlay specified for ADC"
+#define ADC_INPUTS_NODE DT_COMPAT_GET_ANY_STATUS_OKAY(fcapps_adc_inputs)
+
+#if !DT_NODE_EXISTS(ADC_INPUTS_NODE)
+#error "No fcapps,adc-inputs node in devicetree overlay"
 #endif
 
-#define DT_SPEC_AND_COMMA(node_id, prop, idx) \
-	ADC_DT_SPEC_GET_BY_IDX(node_id, idx),
+/* Q16 scale factor: multiplier / divisor */
+#define ADC_SCALE_Q16(node_id) \
+	((int32_t)(((int64_t)DT_PROP(node_id, scale_multiplier) << 16) / \
+		   DT_PROP(node_id, scale_divisor)))
+
+#define ADC_INPUT_INIT(node_id)                                  \
+	{                                                        \
+		.spec = ADC_DT_SPEC_GET(node_id),                \
+		.scale_q16 = ADC_SCALE_Q16(node_id),             \
+		.offset = DT_PROP(node_id, offset),              \
+		.unit = DT_PROP(node_id, unit),                  \
+	},
+
+struct adc_input {
+	struct adc_dt_spec spec;
+	int32_t scale_q16;  /* Divider ratio in Q16 fixed point */
+	int32_t offset;     /* Added after scaling, in `unit` */
+	const char *unit;
+};
+
+/* ADC inputs defined in devicetree, in child node order */
+static const struct adc_input adc_inputs[] = {
+	DT_FOREACH_CHILD_STATUS_OKAY(ADC_INPUTS_NODE, ADC_INPUT_INIT)
+};
 
-/* ADC channels defined in devicetree */
-static const struct adc_dt_spec adc_channel = ADC_DT_SPEC_GET_BY_IDX(DT_PATH(zephyr_user), 0);
+BUILD_ASSERT(ARRAY_SIZE(adc_inputs) > ADC_INPUT_BATTERY,
+	     "fcapps,adc-inputs must define the battery input first");
 
 /* Buffer for ADC sample */
 static int16_t adc_buf;
@@ -54,61 +83,80 @@ int adc_reader_init(void)
 {
 	int err;
 
-	if (!adc_is_ready_dt(&adc_channel)) {
-		LOG_ERR("ADC controller device %s not ready", adc_channel.dev->name);
-		return -ENODEV;
-	}
+	for (int i = 0; i < (int)ARRAY_SIZE(adc_inputs); i++) {
+		const struct adc_dt_spec *spec = &adc_inputs[i].spec;
 
-	err = adc_channel_setup_dt(&adc_channel);
-	if (err < 0) {
-		LOG_ERR("Could not setup ADC channel (%d)", err);
-		return err;
-	}
+		if (!adc_is_ready_dt(spec)) {
+			LOG_ERR("ADC controller device %s not ready", spec->dev->name);
+			return -ENODEV;
+		}
 
-	LOG_INF("ADC initialized on channel %d", adc_channel.channel_id);
+		err = adc_channel_setup_dt(spec);
+		if (err < 0) {
+			LOG_ERR("Could not setup ADC channel %d (%d)", spec->channel_id, err);
+			return err;
+		}
+
+		LOG_INF("ADC input %d on channel %d (unit %s)", i, spec->channel_id,
+			adc_inputs[i].unit);
+	}
 
 	return 0;
 }
 
-int adc_read_raw(int16_t *raw_value)
+int adc_input_count(void)
 {
-	int err;
+	return ARRAY_SIZE(adc_inputs);
+}
 
-	if (raw_value == NULL) {
-		return -EINVAL;
-	}
+static int read_raw(const struct adc_input *input, int16_t *raw_value)
+{
+	int err;
 
-	err = adc_sequence_init_dt(&adc_channel, &sequence);
+	err = adc_sequence_init_dt(&input->spec, &sequence);
 	if (err < 0) {
 		LOG_ERR("Could not initialize ADC sequence (%d)", err);
 		return err;
 	}
 
-	err = adc_read_dt(&adc_channel, &sequence);
+	err = adc_read_dt(&input->spec, &sequence);
 	if (err < 0) {
 		LOG_ERR("Could not read ADC (%d)", err);
 		return err;
 	}
 
 	*raw_value = adc_buf;
+	PERF_COUNT(ADC_CONVERSION);
 
 	return 0;
 }
 
-int adc_read_voltage_mv(int32_t *voltage_mv)
+int adc_read_raw(int16_t *raw_value)
+{
+	if (raw_value == NULL) {
+		return -EINVAL;
+	}
+
+	return read_raw(&adc_inputs[ADC_INPUT_BATTERY], raw_value);
+}
+
+int adc_read_input(int index, int32_t *value)
 {
 	int err;
 	int16_t raw;
 	int32_t sum = 0;
 	int valid_samples = 0;
+	int32_t mv;
 
-	if (voltage_mv == NULL) {
+	if (value == NULL || index < 0 || index >= (int)ARRAY_SIZE(adc_inputs)) {
 		return -EINVAL;
 	}
 
+	const struct adc_input *input = &adc_inputs[index];
+
 	/* Take multiple samples and average to reduce noise */
 	for (int i = 0; i < CONFIG_ADC_OVERSAMPLE_COUNT; i++) {
-		err = adc_read_raw(&raw);
+		err = read_raw(input, &raw);
 		if (err == 0) {
 			sum += raw;
 			valid_samples++;
@@ -128,23 +176,29 @@ int adc_read_voltage_mv(int32_t *voltage_mv)
 	/* Calculate average raw value */
 	int16_t avg_raw = (int16_t)(sum / valid_samples);
 
-	/* Convert averaged raw value to millivolts */
-	*voltage_mv = (int32_t)avg_raw;
-	err = adc_raw_to_millivolts_dt(&adc_channel, voltage_mv);
+	/* Convert averaged raw value to millivolts at the ADC pin */
+	mv = (int32_t)avg_raw;
+	err = adc_raw_to_millivolts_dt(&input->spec, &mv);
 	if (err < 0) {
 		LOG_ERR("Could not convert to millivolts (%d)", err);
 		return err;
 	}
 
-	/* VDDHDIV5 divides VDDH by 5, so multiply to get actual voltage */
-	*voltage_mv *= 5;
+	/* Apply the input's divider ratio and offset (Q16, rounded) */
+	*value = (int32_t)((((int64_t)mv * input->scale_q16) + (1 << 15)) >> 16) +
+		 input->offset;
 
-	LOG_DBG("ADC: %d samples, avg raw=%d, VDDH=%d mV",
-		valid_samples, avg_raw, *voltage_mv);
+	LOG_DBG("ADC input %d: %d samples, avg raw=%d, pin=%d mV, value=%d %s",
+		index, valid_samples, avg_raw, mv, *value, input->unit);
 
 	return 0;
 }
 
+int adc_read_voltage_mv(int32_t *voltage_mv)
+{
+	return adc_read_input(ADC_INPUT_BATTERY, voltage_mv);
+}
+
 /* Periodic reading work item and timer */
 static struct k_work_delayable adc_work;
 static bool periodic_reading_enabled = false;
@@ -154,6 +208,12 @@ static void adc_work_handler(struct k_work *work)
 	int32_t voltage_mv;
 	int err;
 
+	PERF_COUNT(WAKE_ADC);
+
+	/* Piggyback watchdog liveness on this existing periodic wake-up */
+	wdt_supervisor_checkin(WDT_CTX_WORKQUEUE);
+	wdt_supervisor_probe_zboss();
+
 	err = adc_read_voltage_mv(&voltage_mv);
 	if (err == 0) {
 		/* Update Zigbee battery attribute with new voltage reading */
@@ -177,6 +237,9 @@ int adc_start_periodic_reading(void)
 	k_work_init_delayable(&adc_work, adc_work_handler);
 	periodic_reading_enabled = true;
 
+	/* The workqueue now has a guaranteed heartbeat - supervise it */
+	wdt_supervisor_expect(WDT_CTX_WORKQUEUE);
+
 	/* Take first reading immediately */
 	k_work_schedule(&adc_work, K_NO_WAIT);
 
@@ -202,11 +265,21 @@ int adc_reader_init(void)
 	return 0;
 }
 
+int adc_input_count(void)
+{
+	return 0;
+}
+
 int adc_read_raw(int16_t *raw_value)
 {
 	return -ENOTSUP;
 }
 
+int adc_read_input(int index, int32_t *value)
+{
+	return -ENOTSUP;
+}
+
 int adc_read_voltage_mv(int32_t *voltage_mv)
 {
 	return -ENOTSUP;
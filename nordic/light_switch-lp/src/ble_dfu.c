@@ -0,0 +1,290 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @file ble_dfu.c
+ * @brief Local firmware update over BLE (mcumgr/SMP)
+ *
+ * Images are written by mcumgr's image group into the MCUboot secondary
+ * slot, the same slot Zigbee FOTA uses. This module only handles
+ * advertising, pairing, link tuning (2M PHY, DLE, MTU), throughput logging
+ * and the relay handover before the reset that installs the image.
+ *
+ * The SMP characteristic needs an authenticated (passkey) link, so a
+ * central in range cannot upload, erase or reset without the passkey.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/gatt.h>
+#include <zephyr/mgmt/mcumgr/transport/smp_bt.h>
+#include <zephyr/mgmt/mcumgr/mgmt/callbacks.h>
+#include <zephyr/mgmt/mcumgr/grp/img_mgmt/img_mgmt_callbacks.h>
+#include <zephyr/dfu/mcuboot.h>
+#include <ram_pwrdn.h>
+
+#include "ble_dfu.h"
+#include "crash_snapshot.h"
+#include "zigbee_device.h"
+
+LOG_MODULE_REGISTER(ble_dfu, LOG_LEVEL_INF);
+
+#define DEVICE_NAME        CONFIG_BT_DEVICE_NAME
+#define DEVICE_NAME_LEN    (sizeof(DEVICE_NAME) - 1)
+
+static const struct bt_data ad[] = {
+	BT_DATA_BYTES(BT_DATA_FLAGS, (BT_LE_AD_GENERAL | BT_LE_AD_NO_BREDR)),
+	BT_DATA(BT_DATA_NAME_COMPLETE, DEVICE_NAME, DEVICE_NAME_LEN),
+};
+
+static const struct bt_data sd[] = {
+	BT_DATA_BYTES(BT_DATA_UUID128_ALL, SMP_BT_SVC_UUID_VAL),
+};
+
+static struct k_work_delayable adv_stop_work;
+static struct bt_gatt_exchange_params mtu_params;
+
+/* Upload throughput measurement */
+static int64_t upload_start_ms;
+static uint32_t upload_bytes;
+
+static void adv_stop_work_handler(struct k_work *work)
+{
+	ARG_UNUSED(work);
+
+	bt_le_adv_stop();
+	LOG_INF("SMP advertising window closed");
+}
+
+static void mtu_exchange_cb(struct bt_conn *conn, uint8_t err,
+			    struct bt_gatt_exchange_params *params)
+{
+	LOG_INF("MTU exchange %s, MTU %u", err ? "failed" : "done", bt_gatt_get_mtu(conn));
+}
+
+static void connected(struct bt_conn *conn, uint8_t err)
+{
+	int ret;
+
+	if (err) {
+		LOG_ERR("Connection failed (err %u)", err);
+		return;
+	}
+
+	LOG_INF("Connected");
+
+	/* Request the fastest link the central accepts; each step is
+	 * independent so a refusal of one does not block the others.
+	 */
+	ret = bt_conn_le_phy_update(conn, BT_CONN_LE_PHY_PARAM_2M);
+	if (ret) {
+		LOG_WRN("PHY update request failed: %d", ret);
+	}
+
+	ret = bt_conn_le_data_len_update(conn, BT_LE_DATA_LEN_PARAM_MAX);
+	if (ret) {
+		LOG_WRN("Data length update request failed: %d", ret);
+	}
+
+	mtu_params.func = mtu_exchange_cb;
+	ret = bt_gatt_exchange_mtu(conn, &mtu_params);
+	if (ret) {
+		LOG_WRN("MTU exchange request failed: %d", ret);
+	}
+}
+
+static void disconnected(struct bt_conn *conn, uint8_t reason)
+{
+	LOG_INF("Disconnected (reason %u)", reason);
+}
+
+static void security_changed(struct bt_conn *conn, bt_security_t level,
+			     enum bt_security_err err)
+{
+	if (err) {
+		LOG_WRN("Security failed: level %u, error %d", level, err);
+	} else {
+		LOG_INF("Security level %u", level);
+	}
+}
+
+static void le_phy_updated(struct bt_conn *conn, struct bt_conn_le_phy_info *param)
+{
+	LOG_INF("PHY updated: TX %u, RX %u", param->tx_phy, param->rx_phy);
+}
+
+static void le_data_len_updated(struct bt_conn *conn, struct bt_conn_le_data_len_info *info)
+{
+	LOG_INF("Data length updated: TX %u B, RX %u B", info->tx_max_len, info->rx_max_len);
+}
+
+BT_CONN_CB_DEFINE(conn_callbacks) = {
+	.connected = connected,
+	.disconnected = disconnected,
+	.security_changed = security_changed,
+	.le_phy_updated = le_phy_updated,
+	.le_data_len_updated = le_data_len_updated,
+};
+
+/* The passkey is only shown in the log; the central types it in */
+static void auth_passkey_display(struct bt_conn *conn, unsigned int passkey)
+{
+	LOG_INF("Pairing passkey: %06u", passkey);
+}
+
+static void auth_cancel(struct bt_conn *conn)
+{
+	LOG_INF("Pairing cancelled");
+}
+
+static struct bt_conn_auth_cb auth_callbacks = {
+	.passkey_display = auth_passkey_display,
+	.cancel = auth_cancel,
+};
+
+static void pairing_complete(struct bt_conn *conn, bool bonded)
+{
+	LOG_INF("Pairing complete");
+}
+
+static void pairing_failed(struct bt_conn *conn, enum bt_security_err reason)
+{
+	LOG_WRN("Pairing failed: %d", reason);
+}
+
+static struct bt_conn_auth_info_cb auth_info_callbacks = {
+	.pairing_complete = pairing_complete,
+	.pairing_failed = pairing_failed,
+};
+
+static void log_throughput(const char *result)
+{
+	int64_t elapsed_ms = k_uptime_get() - upload_start_ms;
+
+	if (elapsed_ms <= 0) {
+		elapsed_ms = 1;
+	}
+
+	LOG_INF("SMP upload %s: %u B in %lld ms (%lld B/s)", result, upload_bytes,
+		elapsed_ms, ((int64_t)upload_bytes * MSEC_PER_SEC) / elapsed_ms);
+}
+
+static enum mgmt_cb_return img_mgmt_event(uint32_t event, enum mgmt_cb_return prev_status,
+					  int32_t *rc, uint16_t *group, bool *abort_more,
+					  void *data, size_t data_size)
+{
+	switch (event) {
+	case MGMT_EVT_OP_IMG_MGMT_DFU_STARTED:
+		upload_start_ms = k_uptime_get();
+		upload_bytes = 0;
+		LOG_INF("SMP upload started");
+		break;
+
+	case MGMT_EVT_OP_IMG_MGMT_DFU_CHUNK: {
+		const struct img_mgmt_upload_check *check = data;
+
+		upload_bytes = check->req->off + check->req->img_data.len;
+		break;
+	}
+
+	case MGMT_EVT_OP_IMG_MGMT_DFU_PENDING:
+		log_throughput("complete");
+		break;
+
+	case MGMT_EVT_OP_IMG_MGMT_DFU_STOPPED:
+		log_throughput("stopped");
+		break;
+
+	default:
+		break;
+	}
+
+	return MGMT_CB_OK;
+}
+
+static struct mgmt_callback img_mgmt_cb = {
+	.callback = img_mgmt_event,
+	.event_id = MGMT_EVT_OP_IMG_MGMT_ALL,
+};
+
+/* Same preparation as the Zigbee FOTA reboot in zigbee_handlers.c. The
+ * relay is only handed over when MCUboot will install an image marked for
+ * test or confirm; a reset after a rejected or aborted upload is a plain
+ * reboot.
+ */
+static enum mgmt_cb_return os_mgmt_reset_event(uint32_t event, enum mgmt_cb_return prev_status,
+					       int32_t *rc, uint16_t *group, bool *abort_more,
+					       void *data, size_t data_size)
+{
+	int swap_type = mcuboot_swap_type();
+
+	LOG_INF("SMP reset requested (swap type %d)", swap_type);
+	crash_snapshot_trace(CRASH_TRACE_SMP_RESET);
+	if (swap_type == BOOT_SWAP_TYPE_TEST || swap_type == BOOT_SWAP_TYPE_PERM) {
+		crash_snapshot_set_relay_handover(zigbee_device_get_relay_state());
+	}
+	if (IS_ENABLED(CONFIG_RAM_POWER_DOWN_LIBRARY)) {
+		power_up_unused_ram();
+	}
+
+	return MGMT_CB_OK;
+}
+
+static struct mgmt_callback os_mgmt_reset_cb = {
+	.callback = os_mgmt_reset_event,
+	.event_id = MGMT_EVT_OP_OS_MGMT_RESET,
+};
+
+int ble_dfu_init(void)
+{
+	int err;
+
+	mgmt_callback_register(&img_mgmt_cb);
+	mgmt_callback_register(&os_mgmt_reset_cb);
+	k_work_init_delayable(&adv_stop_work, adv_stop_work_handler);
+
+	err = bt_conn_auth_cb_register(&auth_callbacks);
+	if (err) {
+		LOG_ERR("Pairing callbacks registration failed (error: %d)", err);
+		return err;
+	}
+
+	err = bt_conn_auth_info_cb_register(&auth_info_callbacks);
+	if (err) {
+		LOG_ERR("Pairing info callbacks registration failed (error: %d)", err);
+		return err;
+	}
+
+	err = bt_enable(NULL);
+	if (err && err != -EALREADY) {
+		LOG_ERR("Bluetooth initialization failed (error: %d)", err);
+		return err;
+	}
+
+#if CONFIG_BLE_SMP_DFU_PASSKEY > 0
+	err = bt_passkey_set(CONFIG_BLE_SMP_DFU_PASSKEY);
+	if (err) {
+		LOG_ERR("Fixed passkey not set (error: %d)", err);
+		return err;
+	}
+#endif
+
+	err = bt_le_adv_start(BT_LE_ADV_CONN, ad, ARRAY_SIZE(ad), sd, ARRAY_SIZE(sd));
+	if (err) {
+		LOG_ERR("Advertising failed to start (error: %d)", err);
+		return err;
+	}
+
+	if (CONFIG_BLE_SMP_DFU_ADV_WINDOW_SEC > 0) {
+		k_work_schedule(&adv_stop_work, K_SECONDS(CONFIG_BLE_SMP_DFU_ADV_WINDOW_SEC));
+	}
+
+	LOG_INF("SMP over BLE ready (advertising window %d s)",
+		CONFIG_BLE_SMP_DFU_ADV_WINDOW_SEC);
+	return 0;
+}
@@ -12,11 +12,28 @@
  * - Any edge interrupt restarts a short debounce timer
  * - When timer fires (no edges for 30ms), we sample the actual button state
  * - This ensures we act on the settled state, not bouncy edges
+ *
+ * Optional fast path (CONFIG_BUTTON_FAST_PATH):
+ * - The first press edge actuates the relay and starts the HFXO at once
+ * - When the debounce window ends, the settled state confirms the press
+ *   (Zigbee attribute is updated and reported) or rolls the relay back if
+ *   it was noise
+ * - The HFXO is released once the report has been transmitted
+ *
+ * The On/Off report after a press is only sent with
+ * CONFIG_BUTTON_PRESS_REPORT.
  */
 
 #include <zephyr/kernel.h>
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/spinlock.h>
+#include <string.h>
+
+#ifdef CONFIG_BUTTON_FAST_PATH
+#include <zephyr/drivers/clock_control.h>
+#include <zephyr/drivers/clock_control/nrf_clock_control.h>
+#endif
 
 #include <zboss_api.h>
 #include <zigbee/zigbee_app_utils.h>
@@ -24,6 +41,10 @@
 #include "button_handler.h"
 #include "gpio_control.h"
 #include "zigbee_device.h"
+#include "wdt_supervisor.h"
+#include "crash_snapshot.h"
+#include "actuation_scheduler.h"
+#include "perf_counters.h"
 
 LOG_MODULE_REGISTER(button_handler, LOG_LEVEL_INF);
 
@@ -54,6 +75,50 @@ static struct gpio_callback button_cb_data;
 /* User callback */
 static button_event_cb_t user_callback = NULL;
 
+/* Latency measurement: system timer cycles of the first edge of the action */
+static bool edge_armed;
+static uint32_t edge_cyc;
+static uint32_t action_edge_cyc;
+static uint32_t report_edge_cyc;  /* Edge of the press whose report is in flight */
+
+/* Updated from the ISR, the workqueue and the ZBOSS thread */
+static struct button_latency_stats latency_stats;
+static struct k_spinlock latency_lock;
+
+#ifdef CONFIG_BUTTON_FAST_PATH
+/* Tentative actuation done on the first edge, awaiting debounce validation */
+static bool fast_pending;
+static bool fast_target;
+static uint32_t fast_relay_cyc;
+
+static struct onoff_client hfxo_cli;
+static atomic_t hfxo_requested;
+
+/* Start HFXO now so the report TX does not pay its start-up after debounce */
+static void hfxo_prewarm(void)
+{
+	struct onoff_manager *mgr = z_nrf_clock_control_get_onoff(CLOCK_CONTROL_NRF_SUBSYS_HF);
+
+	if (!atomic_cas(&hfxo_requested, 0, 1)) {
+		return;
+	}
+
+	sys_notify_init_spinwait(&hfxo_cli.notify);
+	if (onoff_request(mgr, &hfxo_cli) < 0) {
+		atomic_clear(&hfxo_requested);
+	}
+}
+
+/* Called from the ISR on rollback and from the ZBOSS thread after the TX */
+static void hfxo_release(void)
+{
+	if (atomic_cas(&hfxo_requested, 1, 0)) {
+		onoff_cancel_or_release(z_nrf_clock_control_get_onoff(CLOCK_CONTROL_NRF_SUBSYS_HF),
+					&hfxo_cli);
+	}
+}
+#endif /* CONFIG_BUTTON_FAST_PATH */
+
 /* Forward declarations */
 static void process_button_state(bool pressed);
 
@@ -64,8 +129,13 @@ static void process_button_state(bool pressed);
  */
 static void debounce_timer_handler(struct k_timer *timer)
 {
+	PERF_COUNT(ISR_DEBOUNCE);
+
 	bool pressed = button_get_state();
 	process_button_state(pressed);
+
+	/* Next edge starts a new measurement */
+	edge_armed = false;
 }
 
 /**
@@ -83,7 +153,28 @@ static void process_button_state(bool pressed)
 			LOG_DBG("Button pressed, starting long-press timer");
 			k_timer_start(&factory_reset_timer,
 				      K_MSEC(FACTORY_RESET_TIME_MS), K_NO_WAIT);
+#ifdef CONFIG_BUTTON_FAST_PATH
+			/* Settled pressed - confirm the tentative toggle */
+			if (fast_pending) {
+				action_edge_cyc = edge_cyc;
+				k_work_submit(&short_press_work);
+			}
+#endif
+		}
+#ifdef CONFIG_BUTTON_FAST_PATH
+		else if (fast_pending) {
+			/* Edge was noise - restore the committed relay state */
+			fast_pending = false;
+			actuation_request(0, zigbee_device_get_relay_state());
+			hfxo_release();
+
+			k_spinlock_key_t key = k_spin_lock(&latency_lock);
+
+			latency_stats.rollbacks++;
+			k_spin_unlock(&latency_lock, key);
+			LOG_DBG("Button glitch, relay rolled back");
 		}
+#endif
 		/* else: still idle, ignore */
 		break;
 
@@ -93,7 +184,10 @@ static void process_button_state(bool pressed)
 			btn_state = BTN_IDLE;
 			k_timer_stop(&factory_reset_timer);
 			LOG_DBG("Button released (short press)");
-			k_work_submit(&short_press_work);
+			if (!IS_ENABLED(CONFIG_BUTTON_FAST_PATH)) {
+				action_edge_cyc = edge_cyc;
+				k_work_submit(&short_press_work);
+			}
 		}
 		/* else: still pressed, waiting for release or timeout */
 		break;
@@ -130,10 +224,52 @@ static void factory_reset_timer_handler(struct k_timer *timer)
 static void button_isr(const struct device *dev, struct gpio_callback *cb,
 		       uint32_t pins)
 {
+	PERF_COUNT(ISR_BUTTON);
+
+	if (!edge_armed) {
+		/* First edge of an action is what woke the CPU */
+		PERF_COUNT(WAKE_BUTTON);
+		edge_armed = true;
+		edge_cyc = k_cycle_get_32();
+	}
+
+#ifdef CONFIG_BUTTON_FAST_PATH
+	/* First press edge from idle: act now, validate when debounce ends */
+	if (btn_state == BTN_IDLE && !fast_pending && button_get_state()) {
+		fast_pending = true;
+		fast_target = !zigbee_device_get_relay_state();
+		actuation_request(0, fast_target);
+		fast_relay_cyc = k_cycle_get_32();
+		hfxo_prewarm();
+	}
+#endif
+
 	/* Any edge restarts the debounce timer */
 	k_timer_start(&debounce_timer, K_MSEC(DEBOUNCE_MS), K_NO_WAIT);
 }
 
+/**
+ * @brief On/Off report TX done (ZBOSS context) - press-to-frame latency
+ */
+static void relay_report_sent(bool sent)
+{
+	if (sent) {
+		uint32_t frame_us = k_cyc_to_us_floor32(k_cycle_get_32() - report_edge_cyc);
+		k_spinlock_key_t key = k_spin_lock(&latency_lock);
+
+		latency_stats.frames++;
+		latency_stats.frame_sum_us += frame_us;
+		latency_stats.frame_max_us = MAX(latency_stats.frame_max_us, frame_us);
+		k_spin_unlock(&latency_lock, key);
+		LOG_DBG("Press latency: frame %u us", frame_us);
+	}
+
+#ifdef CONFIG_BUTTON_FAST_PATH
+	/* The radio no longer needs the pre-warmed HFXO */
+	hfxo_release();
+#endif
+}
+
 /**
  * @brief Short press work handler (thread context)
  */
@@ -141,11 +277,41 @@ static void short_press_work_handler(struct k_work *work)
 {
 	ARG_UNUSED(work);
 
+	wdt_supervisor_checkin(WDT_CTX_WORKQUEUE);
+	crash_snapshot_trace(CRASH_TRACE_BUTTON);
+
+	uint32_t relay_cyc;
+
 	/* Inform Zigbee stack about user input */
 	user_input_indicate();
 
+#ifdef CONFIG_BUTTON_FAST_PATH
+	/* Relay already switched on the first edge - commit it to Zigbee */
+	relay_cyc = fast_relay_cyc;
+	zigbee_device_set_relay(fast_target);
+	fast_pending = false;
+#else
 	/* Toggle relay */
+	relay_cyc = k_cycle_get_32();
 	zigbee_device_toggle_relay();
+#endif
+
+	/* Report the new state; press-to-frame is timed at TX done */
+	report_edge_cyc = action_edge_cyc;
+	if (!IS_ENABLED(CONFIG_BUTTON_PRESS_REPORT) ||
+	    !zigbee_device_report_relay(relay_report_sent)) {
+		relay_report_sent(false);
+	}
+
+	uint32_t relay_us = k_cyc_to_us_floor32(relay_cyc - action_edge_cyc);
+	k_spinlock_key_t key = k_spin_lock(&latency_lock);
+
+	latency_stats.presses++;
+	latency_stats.relay_sum_us += relay_us;
+	latency_stats.relay_max_us = MAX(latency_stats.relay_max_us, relay_us);
+	k_spin_unlock(&latency_lock, key);
+	PERF_HIST(PRESS_US, relay_us);
+	LOG_DBG("Press latency: relay %u us", relay_us);
 
 	/* Notify user callback */
 	if (user_callback) {
@@ -212,3 +378,19 @@ int button_handler_init(button_event_cb_t callback)
 		DEBOUNCE_MS, FACTORY_RESET_TIME_MS);
 	return 0;
 }
+
+void button_handler_get_latency(struct button_latency_stats *stats)
+{
+	k_spinlock_key_t key = k_spin_lock(&latency_lock);
+
+	*stats = latency_stats;
+	k_spin_unlock(&latency_lock, key);
+}
+
+void button_handler_reset_latency(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&latency_lock);
+
+	memset(&latency_stats, 0, sizeof(latency_stats));
+	k_spin_unlock(&latency_lock, key);
+}
@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @file crash_snapshot.c
+ * @brief Retained-RAM crash and reset-cause snapshot implementation
+ *
+ * The record is kept in RAM and copied to the crash_retention partition on
+ * every change. The partition lies outside the RAM linked by both MCUboot and
+ * the application, so it survives soft, watchdog and fault resets as well as
+ * the MCUboot run of an update reboot. Power-on and brown-out resets lose RAM;
+ * the retention prefix and checksum detect that and only the hardware reset
+ * cause is reported for those.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/logging/log_ctrl.h>
+#include <zephyr/drivers/hwinfo.h>
+#include <zephyr/fatal.h>
+#include <zephyr/retention/retention.h>
+#include <zephyr/sys/reboot.h>
+#include <string.h>
+
+#include "crash_snapshot.h"
+
+LOG_MODULE_REGISTER(crash_snapshot, LOG_LEVEL_INF);
+
+#define CRASH_RETENTION_NODE DT_NODELABEL(crash_retention)
+
+/* Retained record layout - prefix and checksum are added by the partition */
+struct crash_record {
+	uint32_t fault_reason;
+	uint32_t fault_pc;
+	uint32_t fault_lr;
+	uint32_t uptime_s;
+	uint16_t battery_mv;
+	uint8_t trace_head;
+	uint8_t handover;    /* Relay state handed to the next boot (HANDOVER_*) */
+	uint8_t trace[CRASH_SNAPSHOT_TRACE_LEN];
+};
+
+/* Relay handover values */
+#define HANDOVER_NONE      0
+#define HANDOVER_RELAY_OFF 1
+#define HANDOVER_RELAY_ON  2
+
+/* Partition size less the 4-byte prefix and the 4-byte checksum */
+BUILD_ASSERT(sizeof(struct crash_record) <= DT_REG_SIZE(CRASH_RETENTION_NODE) - 8,
+	     "crash_retention partition too small");
+
+static const struct device *const retention_dev = DEVICE_DT_GET(CRASH_RETENTION_NODE);
+
+/* Working copy of this run's record */
+static struct crash_record record;
+
+/* Previous run's snapshot, captured at boot */
+static struct crash_snapshot_info boot_info;
+static bool report_pending;
+static uint8_t boot_handover;
+
+/* Uptime of each boot phase of this run, in milliseconds */
+static uint32_t boot_phase_ms[BOOT_PHASE_COUNT];
+
+/* Refresh uptime and write the record to retained RAM after any field change */
+static void record_seal(void)
+{
+	record.uptime_s = (uint32_t)(k_uptime_get() / MSEC_PER_SEC);
+	(void)retention_write(retention_dev, 0, (const uint8_t *)&record, sizeof(record));
+}
+
+void crash_snapshot_init(void)
+{
+	uint32_t cause = 0;
+	int err;
+
+	err = hwinfo_get_reset_cause(&cause);
+	if (err == 0) {
+		hwinfo_clear_reset_cause();
+	}
+
+	memset(&boot_info, 0, sizeof(boot_info));
+	boot_info.reset_cause = cause;
+
+	if (!device_is_ready(retention_dev)) {
+		LOG_ERR("Retention partition not ready");
+	} else if (retention_is_valid(retention_dev) == 1 &&
+		   retention_read(retention_dev, 0, (uint8_t *)&record, sizeof(record)) == 0) {
+		boot_info.retained_valid = true;
+		boot_info.fault_reason = record.fault_reason;
+		boot_info.fault_pc = record.fault_pc;
+		boot_info.fault_lr = record.fault_lr;
+		boot_info.battery_mv = record.battery_mv;
+		boot_info.uptime_s = record.uptime_s;
+		boot_info.update_reboot = (record.handover != HANDOVER_NONE);
+		boot_handover = record.handover;
+
+		/* Unroll the ring oldest first */
+		for (int i = 0; i < CRASH_SNAPSHOT_TRACE_LEN; i++) {
+			boot_info.trace[i] =
+				record.trace[(record.trace_head + i) % CRASH_SNAPSHOT_TRACE_LEN];
+		}
+	}
+
+	report_pending = true;
+
+	LOG_INF("Reset cause 0x%08x, retained %s, fault %u at PC 0x%08x",
+		boot_info.reset_cause, boot_info.retained_valid ? "valid" : "lost",
+		boot_info.fault_reason, boot_info.fault_pc);
+
+	/* Start a fresh record for this run */
+	memset(&record, 0, sizeof(record));
+	crash_snapshot_trace(CRASH_TRACE_BOOT);
+}
+
+void crash_snapshot_trace(enum crash_trace_evt evt)
+{
+	unsigned int key = irq_lock();
+
+	record.trace[record.trace_head] = (uint8_t)evt;
+	record.trace_head = (record.trace_head + 1) % CRASH_SNAPSHOT_TRACE_LEN;
+	record_seal();
+
+	irq_unlock(key);
+}
+
+void crash_snapshot_set_battery(int32_t voltage_mv)
+{
+	unsigned int key = irq_lock();
+
+	record.battery_mv = (uint16_t)CLAMP(voltage_mv, 0, UINT16_MAX);
+	record_seal();
+
+	irq_unlock(key);
+}
+
+bool crash_snapshot_take(struct crash_snapshot_info *info)
+{
+	if (!report_pending || info == NULL) {
+		return false;
+	}
+
+	*info = boot_info;
+	report_pending = false;
+	return true;
+}
+
+void crash_snapshot_set_relay_handover(bool on)
+{
+	unsigned int key = irq_lock();
+
+	record.handover = on ? HANDOVER_RELAY_ON : HANDOVER_RELAY_OFF;
+	record_seal();
+
+	irq_unlock(key);
+}
+
+void crash_snapshot_clear_relay_handover(void)
+{
+	unsigned int key = irq_lock();
+
+	if (record.handover != HANDOVER_NONE) {
+		record.handover = HANDOVER_NONE;
+		record_seal();
+	}
+
+	irq_unlock(key);
+}
+
+bool crash_snapshot_take_relay_handover(bool *on)
+{
+	if (boot_handover == HANDOVER_NONE) {
+		return false;
+	}
+
+	*on = (boot_handover == HANDOVER_RELAY_ON);
+	boot_handover = HANDOVER_NONE;
+	return true;
+}
+
+void crash_snapshot_boot_phase(enum boot_phase phase)
+{
+	static const char *const names[BOOT_PHASE_COUNT] = {
+		"main", "relay restored", "stack started", "rejoined",
+	};
+
+	if (phase >= BOOT_PHASE_COUNT || boot_phase_ms[phase] != 0) {
+		return;
+	}
+
+	boot_phase_ms[phase] = (uint32_t)k_uptime_get();
+
+	if (phase == BOOT_PHASE_JOINED && boot_info.update_reboot) {
+		for (int i = 0; i < BOOT_PHASE_COUNT; i++) {
+			LOG_INF("Update boot: %s at %u ms", names[i], boot_phase_ms[i]);
+		}
+	}
+}
+
+uint32_t crash_snapshot_boot_phase_ms(enum boot_phase phase)
+{
+	return (phase < BOOT_PHASE_COUNT) ? boot_phase_ms[phase] : 0;
+}
+
+/**
+ * @brief Fatal error hook - record the fault and reboot
+ *
+ * Overrides the weak default, which halts the CPU and would leave a
+ * battery device dead until the watchdog fires.
+ */
+void k_sys_fatal_error_handler(unsigned int reason, const struct arch_esf *esf)
+{
+	record.fault_reason = reason;
+#ifdef CONFIG_ARM
+	if (esf != NULL) {
+		record.fault_pc = esf->basic.pc;
+		record.fault_lr = esf->basic.lr;
+	}
+#else
+	ARG_UNUSED(esf);
+#endif
+	record.trace[record.trace_head] = CRASH_TRACE_FATAL;
+	record.trace_head = (record.trace_head + 1) % CRASH_SNAPSHOT_TRACE_LEN;
+	record_seal();
+
+	LOG_PANIC();
+	sys_reboot(SYS_REBOOT_COLD);
+	CODE_UNREACHABLE;
+}
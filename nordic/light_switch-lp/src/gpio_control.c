@@ -22,10 +22,21 @@
 
 LOG_MODULE_REGISTER(gpio_control, LOG_LEVEL_INF);
 
-/* Relay GPIO on P0.29 - only if relay0 alias exists in devicetree */
+/* Relay GPIOs - relay0 (P0.29 on Pro Micro) plus optional relay1..relay3
+ * aliases for multi-gang boards
+ */
+#define RELAY_SPEC_AND_COMMA(n)                                                \
+	COND_CODE_1(DT_NODE_EXISTS(DT_ALIAS(relay##n)),                        \
+		    (GPIO_DT_SPEC_GET(DT_ALIAS(relay##n), gpios),), ())
+
 #if DT_NODE_EXISTS(DT_ALIAS(relay0))
 #define HAS_RELAY 1
-static const struct gpio_dt_spec relay_ctrl = GPIO_DT_SPEC_GET(DT_ALIAS(relay0), gpios);
+static const struct gpio_dt_spec relays[] = {
+	RELAY_SPEC_AND_COMMA(0)
+	RELAY_SPEC_AND_COMMA(1)
+	RELAY_SPEC_AND_COMMA(2)
+	RELAY_SPEC_AND_COMMA(3)
+};
 #else
 #define HAS_RELAY 0
 #endif
@@ -75,20 +86,22 @@ int gpio_control_init(void)
 	}
 #endif
 
-	/* Configure relay output on P0.29 (only if defined in devicetree) */
+	/* Configure relay outputs (only if defined in devicetree) */
 #if HAS_RELAY
-	if (!gpio_is_ready_dt(&relay_ctrl)) {
-		LOG_ERR("Relay GPIO not ready");
-		return -ENODEV;
+	for (int i = 0; i < (int)ARRAY_SIZE(relays); i++) {
+		if (!gpio_is_ready_dt(&relays[i])) {
+			LOG_ERR("Relay %d GPIO not ready", i);
+			return -ENODEV;
+		}
+		err = gpio_pin_configure_dt(&relays[i], GPIO_OUTPUT_INACTIVE);
+		if (err) {
+			LOG_ERR("Failed to configure relay %d: %d", i, err);
+			return err;
+		}
+		LOG_INF("Relay %d GPIO initialized on P%d.%02d", i,
+			relays[i].port == DEVICE_DT_GET(DT_NODELABEL(gpio0)) ? 0 : 1,
+			relays[i].pin);
 	}
-	err = gpio_pin_configure_dt(&relay_ctrl, GPIO_OUTPUT_INACTIVE);
-	if (err) {
-		LOG_ERR("Failed to configure relay: %d", err);
-		return err;
-	}
-	LOG_INF("Relay GPIO initialized on P%d.%02d",
-		relay_ctrl.port == DEVICE_DT_GET(DT_NODELABEL(gpio0)) ? 0 : 1,
-		relay_ctrl.pin);
 #else
 	LOG_INF("GPIO initialized (no relay configured)");
 #endif
@@ -110,14 +123,31 @@ void led_power_set(bool on)
 }
 
 void relay_control_set(bool on)
+{
+	relay_control_set_channel(0, on);
+}
+
+void relay_control_set_channel(uint8_t channel, bool on)
 {
 #if HAS_RELAY
-	gpio_pin_set_dt(&relay_ctrl, on ? 1 : 0);
+	if (channel < ARRAY_SIZE(relays)) {
+		gpio_pin_set_dt(&relays[channel], on ? 1 : 0);
+	}
 #else
+	ARG_UNUSED(channel);
 	ARG_UNUSED(on);
 #endif
 }
 
+uint8_t relay_channel_count(void)
+{
+#if HAS_RELAY
+	return ARRAY_SIZE(relays);
+#else
+	return 0;
+#endif
+}
+
 #ifndef CONFIG_DK_LIBRARY
 bool button_get_state(void)
 {
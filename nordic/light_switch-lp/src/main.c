@@ -23,6 +23,10 @@
 #include "zigbee_device.h"
 #include "zigbee_handlers.h"
 #include "adc_reader.h"
+#include "wdt_supervisor.h"
+#include "crash_snapshot.h"
+#include "ble_dfu.h"
+#include "actuation_scheduler.h"
 
 #ifdef CONFIG_DK_LIBRARY
 #include <dk_buttons_and_leds.h>
@@ -34,8 +38,8 @@
 #include <zephyr/usb/usb_device.h>
 #endif
 
-#if !defined ZB_ED_ROLE
-#error Define ZB_ED_ROLE to compile light switch (End Device) source code.
+#if !defined ZB_ED_ROLE && !defined ZB_ROUTER_ROLE
+#error Define ZB_ED_ROLE or ZB_ROUTER_ROLE to compile light switch source code.
 #endif
 
 LOG_MODULE_REGISTER(app, LOG_LEVEL_INF);
@@ -115,6 +119,10 @@ int main(void)
 {
 	int err;
 
+	/* Capture why the previous run ended before anything else can fault */
+	crash_snapshot_init();
+	crash_snapshot_boot_phase(BOOT_PHASE_MAIN);
+
 #if defined(CONFIG_USB_DEVICE_STACK)
 	/* Enable USB CDC ACM for console */
 	err = usb_enable(NULL);
@@ -137,6 +145,12 @@ int main(void)
 		return err;
 	}
 
+	/* All relay actuation goes through the peak-current scheduler */
+	actuation_scheduler_init();
+
+	/* Bring the relay back right away if an update reboot handed it over */
+	zigbee_device_restore_relay();
+
 #ifdef CONFIG_DK_LIBRARY
 	/* Initialize DK buttons and LEDs */
 	err = dk_buttons_init(dk_button_handler);
@@ -167,6 +181,11 @@ int main(void)
 
 	/* Configure Zigbee stack */
 	zigbee_erase_persistent_storage(ERASE_PERSISTENT_CONFIG);
+
+#if defined(ZB_ROUTER_ROLE)
+	/* Mains-powered router: accept sleepy devices as children */
+	zb_set_max_children(CONFIG_ROUTER_MAX_CHILDREN);
+#else
 	zb_set_ed_timeout(ED_AGING_TIMEOUT_64MIN);
 
 	/* Configure as sleepy end device if USB is not enabled */
@@ -176,6 +195,7 @@ int main(void)
 	/* Set keep-alive for low power (10 seconds) */
 	zb_set_keepalive_timeout(ZB_MILLISECONDS_TO_BEACON_INTERVAL(10000));
 #endif
+#endif /* ZB_ROUTER_ROLE */
 
 	/* Power off unused sections of RAM to lower device power consumption */
 	if (IS_ENABLED(CONFIG_RAM_POWER_DOWN_LIBRARY)) {
@@ -191,17 +211,34 @@ int main(void)
 	/* Register device context and callbacks */
 	zigbee_device_register();
 
+	/* Start watchdog supervision before the stack can hang.
+	 * ZBOSS checks in from its signal handler and scheduler callbacks.
+	 */
+	err = wdt_supervisor_init();
+	if (err) {
+		LOG_ERR("Watchdog supervisor initialization failed: %d", err);
+	} else {
+		wdt_supervisor_expect(WDT_CTX_ZBOSS);
+	}
+
 	/* Start Zigbee stack */
+	crash_snapshot_boot_phase(BOOT_PHASE_STACK_STARTED);
 	zigbee_enable();
 
 	LOG_INF("Zigbee Relay Controller started - Relay is %s",
 		zigbee_device_get_relay_state() ? "ON" : "OFF");
 
+	/* Open the local BLE update window if enabled */
+	err = ble_dfu_init();
+	if (err) {
+		LOG_ERR("BLE DFU initialization failed: %d", err);
+	}
+
 	/* Initialize ADC for voltage sensing */
 	err = adc_reader_init();
 	if (err) {
 		LOG_ERR("ADC initialization failed: %d", err);
-	} else {
+	} else if (IS_ENABLED(CONFIG_BATTERY_REPORT)) {
 		/* Start periodic voltage readings */
 		adc_start_periodic_reading();
 	}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @file onoff_collapse.c
+ * @brief Collapse bursts of On/Off commands to one relay actuation
+ *
+ * Kept apart from the ZCL declarations in zigbee_device.c so the scenario
+ * benchmark can run it on native_sim.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include <zboss_api.h>
+
+#include "onoff_collapse.h"
+#include "zigbee_device.h"
+#include "crash_snapshot.h"
+#include "actuation_scheduler.h"
+#include "perf_counters.h"
+
+LOG_MODULE_REGISTER(onoff_collapse, LOG_LEVEL_INF);
+
+/* On/Off commands received since the last relay commit */
+static bool commit_scheduled;
+static uint32_t commands_pending;
+static int64_t burst_start_ms;  /* Uptime of the first command of the burst */
+
+/**@brief Drive the relay to the last commanded state.
+ *
+ * Runs once per burst of On/Off commands, so a parent draining several
+ * queued commands in one or more polls causes a single actuation.
+ */
+static void relay_commit_cb(zb_uint8_t param)
+{
+	bool on = zigbee_device_get_relay_state();
+
+	ARG_UNUSED(param);
+
+	commit_scheduled = false;
+	LOG_DBG("Relay commit: %u command(s) collapsed to %s", commands_pending,
+		on ? "ON" : "OFF");
+	commands_pending = 0;
+
+	actuation_request(0, on);
+	crash_snapshot_trace(on ? CRASH_TRACE_RELAY_ON : CRASH_TRACE_RELAY_OFF);
+}
+
+void onoff_collapse_command(void)
+{
+	int64_t now = k_uptime_get();
+	int64_t delay_ms;
+
+	PERF_COUNT(CMD_ONOFF);
+	commands_pending++;
+
+	if (!commit_scheduled) {
+		burst_start_ms = now;
+	}
+
+	/* Each command re-arms the window, so a backlog delivered over several
+	 * polls still collapses, but never past the latency cap counted from
+	 * the first command.
+	 */
+	delay_ms = MIN(CONFIG_ONOFF_COLLAPSE_WINDOW_MS,
+		       burst_start_ms + CONFIG_ONOFF_COLLAPSE_MAX_MS - now);
+
+	if (commit_scheduled) {
+		if (delay_ms <= 0) {
+			/* Cap reached: the armed commit runs at the cap */
+			return;
+		}
+		ZB_SCHEDULE_APP_ALARM_CANCEL(relay_commit_cb, ZB_ALARM_ANY_PARAM);
+	}
+
+	commit_scheduled = true;
+	ZB_SCHEDULE_APP_ALARM(relay_commit_cb, 0,
+			      ZB_MILLISECONDS_TO_BEACON_INTERVAL((uint32_t)MAX(delay_ms, 0)));
+}
@@ -0,0 +1,385 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @file ota_verify.c
+ * @brief Streaming verification of Zigbee OTA images
+ *
+ * The OTA file is parsed as it arrives, one state per field:
+ * - OTA header: only its length is needed, the rest is skipped
+ * - Upgrade image sub-element header (tag 0x0000)
+ * - MCUboot image header, image and protected TLVs: hashed with SHA-256,
+ *   the same range MCUboot hashes
+ * - Unprotected TLV area: the SHA-256 TLV value is kept, others skipped
+ *
+ * Files that do not carry a single MCUboot image (e.g. nRF53 multi-image
+ * packages) pass through unverified and are left to MCUboot.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+#include <string.h>
+#include <psa/crypto.h>
+
+#include "ota_verify.h"
+
+LOG_MODULE_REGISTER(ota_verify, LOG_LEVEL_INF);
+
+/* Zigbee OTA file format */
+#define OTA_HEADER_PREFIX_LEN    8   /* Up to and including the header length */
+#define OTA_HEADER_LEN_OFFSET    6
+#define OTA_SUBELEMENT_HDR_LEN   6
+#define OTA_TAG_UPGRADE_IMAGE    0x0000
+
+/* MCUboot image format */
+#define IMAGE_MAGIC              0x96f3b83d
+#define IMAGE_HEADER_LEN         32
+#define IMAGE_HDR_SIZE_OFFSET    8
+#define IMAGE_PROT_TLV_OFFSET    10
+#define IMAGE_IMG_SIZE_OFFSET    12
+#define IMAGE_TLV_INFO_MAGIC     0x6907
+#define IMAGE_TLV_INFO_LEN       4
+#define IMAGE_TLV_HDR_LEN        4
+#define IMAGE_TLV_SHA256         0x10
+
+#define SHA256_LEN               32
+
+enum verify_state {
+	VERIFY_IDLE,          /* No transfer in progress */
+	VERIFY_OTA_HEADER,    /* Collecting the OTA header prefix */
+	VERIFY_OTA_SKIP,      /* Skipping the rest of the OTA header */
+	VERIFY_SUBELEMENT,    /* Collecting the sub-element tag and length */
+	VERIFY_IMAGE_HEADER,  /* Collecting the MCUboot image header */
+	VERIFY_IMAGE_BODY,    /* Hashing image and protected TLVs */
+	VERIFY_TLV_INFO,      /* Collecting the TLV area info */
+	VERIFY_TLV_HEADER,    /* Collecting a TLV header */
+	VERIFY_TLV_DIGEST,    /* Collecting the SHA-256 TLV value */
+	VERIFY_TLV_SKIP,      /* Skipping another TLV's value */
+	VERIFY_DONE,          /* Digest captured, trailing data ignored */
+	VERIFY_NO_DIGEST,     /* TLV area ended without a SHA-256 TLV */
+	VERIFY_UNSUPPORTED,   /* Not a single MCUboot image, pass through */
+};
+
+static struct {
+	enum verify_state state;
+	uint32_t next_offset;    /* File offset of the next byte to parse */
+	uint32_t remaining;      /* Bytes to skip or hash in the current state */
+	uint32_t subelement_len; /* Length of the upgrade image sub-element */
+	uint32_t tlv_left;       /* Bytes left in the unprotected TLV area */
+	uint8_t buf[IMAGE_HEADER_LEN];
+	uint32_t buf_len;
+	uint8_t digest[SHA256_LEN];
+	psa_hash_operation_t hash;
+} ctx;
+
+static void enter(enum verify_state state, uint32_t remaining)
+{
+	ctx.state = state;
+	ctx.remaining = remaining;
+	ctx.buf_len = 0;
+}
+
+/* Gather `need` bytes in ctx.buf across blocks. True once complete. */
+static bool collect(const uint8_t **data, uint32_t *len, uint32_t need)
+{
+	uint32_t n = MIN(*len, need - ctx.buf_len);
+
+	memcpy(&ctx.buf[ctx.buf_len], *data, n);
+	ctx.buf_len += n;
+	*data += n;
+	*len -= n;
+
+	return ctx.buf_len == need;
+}
+
+/* Consume up to ctx.remaining bytes, hashing them if asked */
+static int consume(const uint8_t **data, uint32_t *len, bool hash, bool *done)
+{
+	uint32_t n = MIN(*len, ctx.remaining);
+
+	if (hash && psa_hash_update(&ctx.hash, *data, n) != PSA_SUCCESS) {
+		return -EIO;
+	}
+
+	ctx.remaining -= n;
+	*data += n;
+	*len -= n;
+	*done = (ctx.remaining == 0);
+
+	return 0;
+}
+
+static void next_tlv(void)
+{
+	/* MCUboot always emits the SHA-256 TLV; running out of TLVs means it
+	 * is missing, which the check step reports.
+	 */
+	enter(ctx.tlv_left >= IMAGE_TLV_HDR_LEN ? VERIFY_TLV_HEADER : VERIFY_NO_DIGEST, 0);
+}
+
+static int parse_image_header(void)
+{
+	uint32_t magic = sys_get_le32(&ctx.buf[0]);
+	uint16_t hdr_size = sys_get_le16(&ctx.buf[IMAGE_HDR_SIZE_OFFSET]);
+	uint16_t prot_tlv_size = sys_get_le16(&ctx.buf[IMAGE_PROT_TLV_OFFSET]);
+	uint32_t img_size = sys_get_le32(&ctx.buf[IMAGE_IMG_SIZE_OFFSET]);
+	uint64_t hashed = (uint64_t)hdr_size + img_size + prot_tlv_size;
+
+	if (magic != IMAGE_MAGIC) {
+		LOG_INF("OTA image is not a single MCUboot image, not verified");
+		enter(VERIFY_UNSUPPORTED, 0);
+		return 0;
+	}
+
+	if (hdr_size < IMAGE_HEADER_LEN ||
+	    hashed + IMAGE_TLV_INFO_LEN > ctx.subelement_len) {
+		LOG_ERR("Inconsistent image header: hdr %u, img %u, prot TLV %u, element %u",
+			hdr_size, img_size, prot_tlv_size, ctx.subelement_len);
+		return -EBADMSG;
+	}
+
+	if (psa_hash_update(&ctx.hash, ctx.buf, IMAGE_HEADER_LEN) != PSA_SUCCESS) {
+		return -EIO;
+	}
+
+	LOG_INF("Verifying MCUboot image: %u bytes hashed", (uint32_t)hashed);
+	enter(VERIFY_IMAGE_BODY, (uint32_t)hashed - IMAGE_HEADER_LEN);
+	return 0;
+}
+
+static int process(const uint8_t *data, uint32_t len)
+{
+	bool done;
+	int err = 0;
+
+	while (len > 0 && err == 0) {
+		switch (ctx.state) {
+		case VERIFY_OTA_HEADER:
+			if (collect(&data, &len, OTA_HEADER_PREFIX_LEN)) {
+				uint16_t hdr_len = sys_get_le16(&ctx.buf[OTA_HEADER_LEN_OFFSET]);
+
+				if (hdr_len < OTA_HEADER_PREFIX_LEN) {
+					LOG_ERR("Invalid OTA header length %u", hdr_len);
+					return -EBADMSG;
+				}
+				enter(VERIFY_OTA_SKIP, hdr_len - OTA_HEADER_PREFIX_LEN);
+			}
+			break;
+
+		case VERIFY_OTA_SKIP:
+			err = consume(&data, &len, false, &done);
+			if (done) {
+				enter(VERIFY_SUBELEMENT, 0);
+			}
+			break;
+
+		case VERIFY_SUBELEMENT:
+			if (collect(&data, &len, OTA_SUBELEMENT_HDR_LEN)) {
+				if (sys_get_le16(&ctx.buf[0]) != OTA_TAG_UPGRADE_IMAGE) {
+					LOG_INF("OTA file does not start with an upgrade image");
+					enter(VERIFY_UNSUPPORTED, 0);
+					break;
+				}
+				ctx.subelement_len = sys_get_le32(&ctx.buf[2]);
+				enter(VERIFY_IMAGE_HEADER, 0);
+			}
+			break;
+
+		case VERIFY_IMAGE_HEADER:
+			if (collect(&data, &len, IMAGE_HEADER_LEN)) {
+				err = parse_image_header();
+			}
+			break;
+
+		case VERIFY_IMAGE_BODY:
+			err = consume(&data, &len, true, &done);
+			if (done) {
+				enter(VERIFY_TLV_INFO, 0);
+			}
+			break;
+
+		case VERIFY_TLV_INFO:
+			if (collect(&data, &len, IMAGE_TLV_INFO_LEN)) {
+				uint16_t tlv_tot = sys_get_le16(&ctx.buf[2]);
+
+				if (sys_get_le16(&ctx.buf[0]) != IMAGE_TLV_INFO_MAGIC ||
+				    tlv_tot < IMAGE_TLV_INFO_LEN) {
+					LOG_ERR("Invalid image TLV area");
+					return -EBADMSG;
+				}
+				ctx.tlv_left = tlv_tot - IMAGE_TLV_INFO_LEN;
+				next_tlv();
+			}
+			break;
+
+		case VERIFY_TLV_HEADER:
+			if (collect(&data, &len, IMAGE_TLV_HDR_LEN)) {
+				uint16_t type = sys_get_le16(&ctx.buf[0]);
+				uint16_t tlv_len = sys_get_le16(&ctx.buf[2]);
+
+				ctx.tlv_left -= IMAGE_TLV_HDR_LEN;
+				if (tlv_len > ctx.tlv_left) {
+					LOG_ERR("Image TLV 0x%02x overruns TLV area", type);
+					return -EBADMSG;
+				}
+				ctx.tlv_left -= tlv_len;
+
+				if (type == IMAGE_TLV_SHA256) {
+					if (tlv_len != SHA256_LEN) {
+						LOG_ERR("Invalid SHA-256 TLV length %u", tlv_len);
+						return -EBADMSG;
+					}
+					enter(VERIFY_TLV_DIGEST, 0);
+				} else {
+					enter(VERIFY_TLV_SKIP, tlv_len);
+					if (tlv_len == 0) {
+						next_tlv();
+					}
+				}
+			}
+			break;
+
+		case VERIFY_TLV_DIGEST:
+			if (collect(&data, &len, SHA256_LEN)) {
+				memcpy(ctx.digest, ctx.buf, SHA256_LEN);
+				enter(VERIFY_DONE, 0);
+			}
+			break;
+
+		case VERIFY_TLV_SKIP:
+			err = consume(&data, &len, false, &done);
+			if (done) {
+				next_tlv();
+			}
+			break;
+
+		default:
+			/* Idle, done, no digest or unsupported: nothing left to parse */
+			return 0;
+		}
+	}
+
+	return err;
+}
+
+static void reset(enum verify_state state)
+{
+	psa_hash_abort(&ctx.hash);
+	ctx.hash = psa_hash_operation_init();
+	ctx.next_offset = 0;
+	ctx.subelement_len = 0;
+	ctx.tlv_left = 0;
+	enter(state, 0);
+}
+
+static bool reject(zb_zcl_ota_upgrade_value_param_t *value, const char *reason)
+{
+	LOG_ERR("OTA image rejected: %s", reason);
+	value->upgrade_status = ZB_ZCL_OTA_UPGRADE_STATUS_ERROR;
+	reset(VERIFY_IDLE);
+	return false;
+}
+
+static bool on_receive(zb_zcl_ota_upgrade_value_param_t *value)
+{
+	uint32_t offset = value->upgrade.receive.file_offset;
+	uint32_t len = value->upgrade.receive.data_length;
+	const uint8_t *data = value->upgrade.receive.block_data;
+
+	if (ctx.state == VERIFY_IDLE) {
+		return true;
+	}
+
+	if (offset > ctx.next_offset) {
+		return reject(value, "gap in received blocks");
+	}
+
+	/* Skip what a retransmitted block repeats */
+	if (offset + len <= ctx.next_offset) {
+		return true;
+	}
+	data += ctx.next_offset - offset;
+	len -= ctx.next_offset - offset;
+	ctx.next_offset += len;
+
+	if (process(data, len) != 0) {
+		return reject(value, "malformed image");
+	}
+
+	return true;
+}
+
+static bool on_check(zb_zcl_ota_upgrade_value_param_t *value)
+{
+	uint8_t hash[SHA256_LEN];
+	size_t hash_len;
+
+	switch (ctx.state) {
+	case VERIFY_IDLE:
+	case VERIFY_UNSUPPORTED:
+		return true;
+
+	case VERIFY_DONE:
+		break;
+
+	case VERIFY_NO_DIGEST:
+		return reject(value, "SHA-256 TLV missing");
+
+	default:
+		return reject(value, "image incomplete");
+	}
+
+	if (psa_hash_finish(&ctx.hash, hash, sizeof(hash), &hash_len) != PSA_SUCCESS) {
+		return reject(value, "hash failed");
+	}
+
+	if (memcmp(hash, ctx.digest, SHA256_LEN) != 0) {
+		return reject(value, "SHA-256 mismatch");
+	}
+
+	LOG_INF("OTA image SHA-256 verified");
+	reset(VERIFY_IDLE);
+	return true;
+}
+
+bool ota_verify_value_cb(zb_zcl_ota_upgrade_value_param_t *value)
+{
+	switch (value->upgrade_status) {
+	case ZB_ZCL_OTA_UPGRADE_STATUS_START:
+		reset(VERIFY_OTA_HEADER);
+		if (psa_hash_setup(&ctx.hash, PSA_ALG_SHA_256) != PSA_SUCCESS) {
+			LOG_WRN("SHA-256 unavailable, OTA image not verified");
+			reset(VERIFY_IDLE);
+		}
+		return true;
+
+	case ZB_ZCL_OTA_UPGRADE_STATUS_RECEIVE:
+		return on_receive(value);
+
+	case ZB_ZCL_OTA_UPGRADE_STATUS_CHECK:
+		return on_check(value);
+
+	case ZB_ZCL_OTA_UPGRADE_STATUS_ABORT:
+		reset(VERIFY_IDLE);
+		return true;
+
+	default:
+		return true;
+	}
+}
+
+int ota_verify_init(void)
+{
+	psa_status_t status = psa_crypto_init();
+
+	if (status != PSA_SUCCESS) {
+		LOG_ERR("PSA crypto init failed: %d", status);
+		return -EIO;
+	}
+
+	return 0;
+}
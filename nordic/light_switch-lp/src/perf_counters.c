@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @file perf_counters.c
+ * @brief Development performance counters and the "perf" shell group
+ *
+ * Counters and histogram buckets are plain atomics so they can be bumped
+ * from ISRs. "perf show" prints them together with the statistics other
+ * modules already keep (actuation and button latency, kernel heap and stack
+ * high-water marks); "perf reset" clears everything that can be cleared,
+ * so a test rig can take a snapshot before and after a change.
+ * Without a shell the counters are still readable through
+ * perf_counter_get(), which the scenario benchmark uses.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+
+#include "perf_counters.h"
+
+#ifdef CONFIG_SHELL
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/sys_heap.h>
+
+#include "actuation_scheduler.h"
+
+#ifndef CONFIG_DK_LIBRARY
+#include "button_handler.h"
+#endif
+#endif /* CONFIG_SHELL */
+
+/* Bucket 0 holds 0 us, bucket n holds [2^(n-1), 2^n) us, the last is open */
+#define PERF_HIST_BUCKETS 20
+
+static atomic_t counters[PERF_COUNTER_COUNT];
+static atomic_t hist[PERF_HIST_COUNT][PERF_HIST_BUCKETS];
+
+/* Heaps are listed through the public heap registry, which needs a slot
+ * per heap (CONFIG_SYS_HEAP_ARRAY_SIZE)
+ */
+#if defined(CONFIG_SYS_HEAP_RUNTIME_STATS) && (CONFIG_SYS_HEAP_ARRAY_SIZE > 0)
+#define PERF_HEAP_STATS 1
+#endif
+
+void perf_counter_inc(enum perf_counter counter)
+{
+	atomic_inc(&counters[counter]);
+}
+
+uint32_t perf_counter_get(enum perf_counter counter)
+{
+	return (uint32_t)atomic_get(&counters[counter]);
+}
+
+void perf_counters_reset(void)
+{
+	for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+		atomic_clear(&counters[i]);
+	}
+
+	for (int h = 0; h < PERF_HIST_COUNT; h++) {
+		for (int b = 0; b < PERF_HIST_BUCKETS; b++) {
+			atomic_clear(&hist[h][b]);
+		}
+	}
+}
+
+void perf_hist_record(enum perf_hist h, uint32_t value_us)
+{
+	unsigned int bucket = (value_us == 0) ? 0 : 32 - __builtin_clz(value_us);
+
+	atomic_inc(&hist[h][MIN(bucket, PERF_HIST_BUCKETS - 1)]);
+}
+
+#ifdef CONFIG_SHELL
+
+static const char *const counter_names[PERF_COUNTER_COUNT] = {
+	[PERF_WAKE_BUTTON] = "wake.button",
+	[PERF_WAKE_ADC] = "wake.adc",
+	[PERF_WAKE_ZBOSS] = "wake.zboss",
+	[PERF_WAKE_ACTUATION] = "wake.actuation",
+	[PERF_ISR_BUTTON] = "isr.button",
+	[PERF_ISR_DEBOUNCE] = "isr.debounce",
+	[PERF_CMD_ONOFF] = "cmd.onoff",
+	[PERF_REPORT_BATTERY] = "report.battery",
+	[PERF_REPORT_RELAY] = "report.relay",
+	[PERF_ZBOSS_NO_BUF] = "zboss.no_buf",
+	[PERF_REPORT_RESET_DIAG] = "report.reset_diag",
+	[PERF_ADC_CONVERSION] = "adc.conversions",
+};
+
+static const char *const hist_names[PERF_HIST_COUNT] = {
+	[PERF_HIST_ACTUATION_US] = "actuation latency",
+	[PERF_HIST_PRESS_US] = "press-to-relay latency",
+};
+
+static void show_hist(const struct shell *sh, enum perf_hist h)
+{
+	shell_print(sh, "%s:", hist_names[h]);
+
+	for (int b = 0; b < PERF_HIST_BUCKETS; b++) {
+		atomic_val_t count = atomic_get(&hist[h][b]);
+		uint32_t lo = (b == 0) ? 0 : BIT(b - 1);
+
+		if (count == 0) {
+			continue;
+		}
+
+		if (b == PERF_HIST_BUCKETS - 1) {
+			shell_print(sh, "  >= %u us: %ld", lo, (long)count);
+		} else {
+			shell_print(sh, "  %u..%u us: %ld", lo, (uint32_t)BIT(b) - 1, (long)count);
+		}
+	}
+}
+
+static void show_thread_stack(const struct k_thread *thread, void *user_data)
+{
+	const struct shell *sh = user_data;
+	struct k_thread *t = (struct k_thread *)thread;
+	const char *name = k_thread_name_get(t);
+	size_t unused = 0;
+
+	if (k_thread_stack_space_get(t, &unused) != 0) {
+		return;
+	}
+
+	shell_print(sh, "  %-20s %u/%u B used", (name && name[0]) ? name : "?",
+		    (unsigned int)(t->stack_info.size - unused),
+		    (unsigned int)t->stack_info.size);
+}
+
+static int cmd_perf_show(const struct shell *sh, size_t argc, char **argv)
+{
+	struct actuation_stats act;
+
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	shell_print(sh, "uptime: %lld ms", k_uptime_get());
+
+	for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+		shell_print(sh, "%-20s %ld", counter_names[i], (long)atomic_get(&counters[i]));
+	}
+
+	actuation_scheduler_get_stats(&act);
+	shell_print(sh, "actuation: %u pulses, %u deferred, %u skipped, avg %u us, max %u us, "
+		    "peak %u mA", act.actuations, act.deferred, act.skipped,
+		    act.actuations ? (uint32_t)(act.latency_sum_us / act.actuations) : 0,
+		    act.latency_max_us, act.peak_load_ma);
+
+#ifndef CONFIG_DK_LIBRARY
+	struct button_latency_stats btn;
+
+	button_handler_get_latency(&btn);
+	shell_print(sh, "button: %u presses, %u rollbacks, relay avg %u/max %u us, "
+		    "%u frames, tx-done avg %u/max %u us",
+		    btn.presses, btn.rollbacks,
+		    btn.presses ? (uint32_t)(btn.relay_sum_us / btn.presses) : 0,
+		    btn.relay_max_us, btn.frames,
+		    btn.frames ? (uint32_t)(btn.frame_sum_us / btn.frames) : 0,
+		    btn.frame_max_us);
+#endif
+
+	for (int h = 0; h < PERF_HIST_COUNT; h++) {
+		show_hist(sh, h);
+	}
+
+#ifdef PERF_HEAP_STATS
+	struct sys_memory_stats heap;
+	struct sys_heap **heaps;
+	int heap_count = sys_heap_array_get(&heaps);
+
+	for (int i = 0; i < heap_count; i++) {
+		if (sys_heap_runtime_stats_get(heaps[i], &heap) == 0) {
+			shell_print(sh, "kernel heap %d: %u B used, %u B high-water, %u B free", i,
+				    (unsigned int)heap.allocated_bytes,
+				    (unsigned int)heap.max_allocated_bytes,
+				    (unsigned int)heap.free_bytes);
+		}
+	}
+#endif
+
+	/* Unlocked walk: printing may block on the shell transport */
+	shell_print(sh, "stack high-water:");
+	k_thread_foreach_unlocked(show_thread_stack, (void *)sh);
+
+	return 0;
+}
+
+static int cmd_perf_reset(const struct shell *sh, size_t argc, char **argv)
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	perf_counters_reset();
+	actuation_scheduler_reset_stats();
+#ifndef CONFIG_DK_LIBRARY
+	button_handler_reset_latency();
+#endif
+#ifdef PERF_HEAP_STATS
+	struct sys_heap **heaps;
+	int heap_count = sys_heap_array_get(&heaps);
+
+	for (int i = 0; i < heap_count; i++) {
+		sys_heap_runtime_stats_reset_max(heaps[i]);
+	}
+#endif
+
+	/* Stack high-water marks come from the stack fill pattern and
+	 * cannot be reset at run time.
+	 */
+	shell_print(sh, "Performance counters reset");
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_perf,
+	SHELL_CMD(show, NULL, "Print all counters, histograms and high-water marks",
+		  cmd_perf_show),
+	SHELL_CMD(reset, NULL, "Reset counters, histograms and latency statistics",
+		  cmd_perf_reset),
+	SHELL_SUBCMD_SET_END
+);
+
+SHELL_CMD_REGISTER(perf, &sub_perf, "Application performance counters", NULL);
+
+#endif /* CONFIG_SHELL */
@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @file report_policy.c
+ * @brief Decisions on which attribute reports the device sends
+ */
+
+#include <zephyr/kernel.h>
+#include <stdlib.h>
+
+#include "report_policy.h"
+
+/* Report when voltage changes by 50mV (5 x 10mV units) */
+#define BATTERY_REPORT_THRESHOLD 5
+
+/* Network join status - only send reports when joined */
+static bool network_joined;
+static uint16_t battery_last_reported;  /* 10 mV units */
+
+void report_policy_set_joined(bool joined)
+{
+	network_joined = joined;
+}
+
+bool report_policy_joined(void)
+{
+	return network_joined;
+}
+
+bool report_policy_relay(void)
+{
+	return network_joined;
+}
+
+bool report_policy_battery(uint16_t voltage_10mv)
+{
+	if (abs((int32_t)voltage_10mv - battery_last_reported) < BATTERY_REPORT_THRESHOLD) {
+		return false;
+	}
+
+	battery_last_reported = voltage_10mv;
+	return network_joined;
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @file wdt_supervisor.c
+ * @brief Sleep-aware watchdog supervisor implementation
+ *
+ * Liveness bitmap approach:
+ * - Every supervised context sets its bit when it runs on an existing wake-up
+ * - When all expected bits are set, the watchdog is fed and the bitmap cleared
+ * - A hung context stops setting its bit, feeds stop and the watchdog resets
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/watchdog.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/atomic.h>
+
+#include <zboss_api.h>
+
+#include "wdt_supervisor.h"
+
+LOG_MODULE_REGISTER(wdt_supervisor, LOG_LEVEL_INF);
+
+#define WDT_NODE DT_NODELABEL(wdt0)
+
+#if !DT_NODE_HAS_STATUS(WDT_NODE, okay)
+#error "CONFIG_WDT_SUPERVISOR requires wdt0 to be enabled in devicetree"
+#endif
+
+/* The slowest heartbeat is the periodic ADC work, which also probes ZBOSS.
+ * Allow one missed period before the watchdog fires.
+ */
+BUILD_ASSERT(CONFIG_WDT_SUPERVISOR_TIMEOUT_SEC >= 2 * CONFIG_ADC_READING_INTERVAL_SEC,
+	     "Watchdog timeout must cover at least two ADC reading intervals");
+
+#define WDT_TIMEOUT_MS (CONFIG_WDT_SUPERVISOR_TIMEOUT_SEC * 1000U)
+
+static const struct device *const wdt_dev = DEVICE_DT_GET(WDT_NODE);
+static int wdt_channel = -1;
+
+/* Contexts that must check in before each feed */
+static atomic_t expected_mask;
+/* Contexts that checked in since the last feed */
+static atomic_t seen_mask;
+
+int wdt_supervisor_init(void)
+{
+	int err;
+	struct wdt_timeout_cfg cfg = {
+		.window.min = 0,
+		.window.max = WDT_TIMEOUT_MS,
+		.callback = NULL,
+		.flags = WDT_FLAG_RESET_SOC,
+	};
+
+	if (!device_is_ready(wdt_dev)) {
+		LOG_ERR("Watchdog device %s not ready", wdt_dev->name);
+		return -ENODEV;
+	}
+
+	err = wdt_install_timeout(wdt_dev, &cfg);
+	if (err < 0) {
+		LOG_ERR("Failed to install watchdog timeout: %d", err);
+		return err;
+	}
+	wdt_channel = err;
+
+	/* Keep counting while the CPU sleeps, otherwise a context that never
+	 * wakes up again would go unnoticed. Pause only for the debugger.
+	 */
+	err = wdt_setup(wdt_dev, WDT_OPT_PAUSE_HALTED_BY_DBG);
+	if (err < 0) {
+		LOG_ERR("Failed to start watchdog: %d", err);
+		wdt_channel = -1;
+		return err;
+	}
+
+	LOG_INF("Watchdog supervisor started (timeout=%ds)",
+		CONFIG_WDT_SUPERVISOR_TIMEOUT_SEC);
+	return 0;
+}
+
+void wdt_supervisor_expect(enum wdt_ctx ctx)
+{
+	atomic_or(&expected_mask, BIT(ctx));
+}
+
+void wdt_supervisor_checkin(enum wdt_ctx ctx)
+{
+	atomic_val_t expected = atomic_get(&expected_mask);
+	atomic_val_t seen = atomic_or(&seen_mask, BIT(ctx)) | BIT(ctx);
+
+	if (wdt_channel < 0 || expected == 0) {
+		return;
+	}
+
+	if ((seen & expected) != expected) {
+		return;
+	}
+
+	/* All expected contexts alive - only the caller that clears the
+	 * bitmap feeds, so concurrent check-ins do not double-feed.
+	 */
+	if (atomic_cas(&seen_mask, seen, 0)) {
+		wdt_feed(wdt_dev, wdt_channel);
+		LOG_DBG("Watchdog fed (contexts=0x%02lx)", (unsigned long)seen);
+	}
+}
+
+/* Runs in ZBOSS context */
+static void zboss_probe_cb(zb_uint8_t param)
+{
+	ARG_UNUSED(param);
+	wdt_supervisor_checkin(WDT_CTX_ZBOSS);
+}
+
+void wdt_supervisor_probe_zboss(void)
+{
+	ZB_SCHEDULE_APP_CALLBACK(zboss_probe_cb, 0);
+}
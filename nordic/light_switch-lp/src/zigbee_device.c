@@ -11,6 +11,7 @@
 
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
+#include <string.h>
 
 #include <zboss_api.h>
 #include <zboss_api_addons.h>
@@ -21,9 +22,15 @@
 #include "zigbee_device.h"
 #include "zigbee_handlers.h"
 #include "gpio_control.h"
+#include "crash_snapshot.h"
+#include "actuation_scheduler.h"
+#include "onoff_collapse.h"
+#include "report_policy.h"
+#include "perf_counters.h"
 
 #if CONFIG_ZIGBEE_FOTA
 #include <zigbee/zigbee_fota.h>
+#include "ota_verify.h"
 #endif
 
 LOG_MODULE_REGISTER(zigbee_device, LOG_LEVEL_INF);
@@ -45,22 +52,54 @@ struct zb_relay_ctx {
 /* Power Configuration cluster attributes for battery reporting */
 static zb_uint16_t battery_voltage;           /* Units of 10mV (e.g., 406 = 4.06V) */
 static zb_uint8_t battery_percentage;         /* Half-percent units (200 = 100%) */
-static zb_uint16_t battery_voltage_last_reported;  /* For threshold reporting */
 
 /* Li-ion battery voltage range for percentage calculation */
 #define BATTERY_MIN_MV  3000  /* 3.0V = 0% */
 #define BATTERY_MAX_MV  4200  /* 4.2V = 100% */
-#define BATTERY_REPORT_THRESHOLD  5  /* Report when voltage changes by 50mV (5 x 10mV units) */
+
+#ifdef CONFIG_RESET_DIAG_REPORT
+#ifndef CONFIG_RESET_DIAG_MANUFACTURER_CODE
+#error "Set CONFIG_RESET_DIAG_MANUFACTURER_CODE to the assigned manufacturer code"
+#endif
+
+/* Manufacturer-specific reset diagnostics cluster, reported once after join */
+#define ZB_ZCL_CLUSTER_ID_RESET_DIAG   0xFC01
+#define ZB_ZCL_CLUSTER_ID_RESET_DIAG_SERVER_ROLE_INIT (zb_zcl_cluster_init_t)NULL
+#define ZB_ZCL_CLUSTER_ID_RESET_DIAG_CLIENT_ROLE_INIT (zb_zcl_cluster_init_t)NULL
+#define RESET_DIAG_ATTR_RESET_CAUSE    0x0000  /* U32: hwinfo RESET_* flags */
+#define RESET_DIAG_ATTR_FAULT_REASON   0x0001  /* U32: K_ERR_* reason */
+#define RESET_DIAG_ATTR_FAULT_PC       0x0002  /* U32 */
+#define RESET_DIAG_ATTR_FAULT_LR       0x0003  /* U32 */
+#define RESET_DIAG_ATTR_BATTERY_MV     0x0004  /* U16: battery before reset */
+#define RESET_DIAG_ATTR_UPTIME_S       0x0005  /* U32: uptime before reset */
+#define RESET_DIAG_ATTR_TRACE          0x0006  /* Octet string: last events */
+#define RESET_DIAG_ATTR_REJOIN_MS      0x0007  /* U32: boot-to-rejoin time of this run */
+
+/* Retry interval when no buffer is free for the report */
+#define RESET_DIAG_RETRY_MS            1000
+#endif /* CONFIG_RESET_DIAG_REPORT */
 
 static struct relay_context relay_ctx;
 static struct zb_relay_ctx relay_dev_ctx;
 
-/* Network join status - only send reports when joined */
-static bool network_joined = false;
+/* Completion callback of the pending relay report */
+static void (*relay_report_sent_cb)(bool sent);
+
+#ifdef CONFIG_RESET_DIAG_REPORT
+/* Previous run's reset snapshot, pending a single report after join */
+static struct crash_snapshot_info reset_diag;
+static zb_uint32_t reset_diag_rejoin_ms;
+static zb_uint8_t reset_diag_trace[1 + CRASH_SNAPSHOT_TRACE_LEN]; /* ZCL octet string */
+static zb_uint16_t reset_diag_cluster_revision = 1;
+#endif
 
 /* Forward declaration */
 static void zcl_device_cb(zb_bufid_t bufid);
 static zb_uint8_t zcl_on_off_handler(zb_bufid_t bufid);
+static void schedule_app_tx(zb_callback_t cb);
+#ifdef CONFIG_RESET_DIAG_REPORT
+static void reset_diag_report_cb(zb_uint8_t param);
+#endif
 
 /* =============================================================================
  * RELAY ENDPOINT (EP 2) - On/Off Switch device type
@@ -83,6 +122,7 @@ ZB_ZCL_DECLARE_IDENTIFY_SERVER_ATTRIB_LIST(
 	relay_identify_server_attr_list,
 	&relay_dev_ctx.identify_attr.identify_time);
 
+#ifdef CONFIG_BATTERY_REPORT
 /* Power Configuration cluster attribute list - using custom U16 for voltage (10mV units) */
 static zb_uint16_t power_config_cluster_revision = ZB_ZCL_POWER_CONFIG_CLUSTER_REVISION_DEFAULT;
 
@@ -116,12 +156,58 @@ static zb_zcl_attr_t relay_power_config_attr_list[] = {
 		NULL
 	}
 };
+#endif /* CONFIG_BATTERY_REPORT */
 
 /* Declare attribute list for On/Off cluster (server) for relay endpoint */
 ZB_ZCL_DECLARE_ON_OFF_ATTRIB_LIST(
 	relay_on_off_server_attr_list,
 	&relay_dev_ctx.on_off_attr.on_off);
 
+#ifdef CONFIG_RESET_DIAG_REPORT
+#define RESET_DIAG_ATTR_DESC(id, type, data)                                      \
+	{ (id), (type), ZB_ZCL_ATTR_ACCESS_READ_ONLY | ZB_ZCL_ATTR_MANUF_SPEC,    \
+	  CONFIG_RESET_DIAG_MANUFACTURER_CODE, (void *)(data) }
+
+/* Reset diagnostics cluster attribute list - values of the last report */
+static zb_zcl_attr_t relay_reset_diag_attr_list[] = {
+	RESET_DIAG_ATTR_DESC(RESET_DIAG_ATTR_RESET_CAUSE, ZB_ZCL_ATTR_TYPE_U32,
+			     &reset_diag.reset_cause),
+	RESET_DIAG_ATTR_DESC(RESET_DIAG_ATTR_FAULT_REASON, ZB_ZCL_ATTR_TYPE_U32,
+			     &reset_diag.fault_reason),
+	RESET_DIAG_ATTR_DESC(RESET_DIAG_ATTR_FAULT_PC, ZB_ZCL_ATTR_TYPE_U32,
+			     &reset_diag.fault_pc),
+	RESET_DIAG_ATTR_DESC(RESET_DIAG_ATTR_FAULT_LR, ZB_ZCL_ATTR_TYPE_U32,
+			     &reset_diag.fault_lr),
+	RESET_DIAG_ATTR_DESC(RESET_DIAG_ATTR_BATTERY_MV, ZB_ZCL_ATTR_TYPE_U16,
+			     &reset_diag.battery_mv),
+	RESET_DIAG_ATTR_DESC(RESET_DIAG_ATTR_UPTIME_S, ZB_ZCL_ATTR_TYPE_U32,
+			     &reset_diag.uptime_s),
+	RESET_DIAG_ATTR_DESC(RESET_DIAG_ATTR_TRACE, ZB_ZCL_ATTR_TYPE_OCTET_STRING,
+			     reset_diag_trace),
+	RESET_DIAG_ATTR_DESC(RESET_DIAG_ATTR_REJOIN_MS, ZB_ZCL_ATTR_TYPE_U32,
+			     &reset_diag_rejoin_ms),
+	{
+		ZB_ZCL_ATTR_GLOBAL_CLUSTER_REVISION_ID,
+		ZB_ZCL_ATTR_TYPE_U16,
+		ZB_ZCL_ATTR_ACCESS_READ_ONLY,
+		ZB_ZCL_NON_MANUFACTURER_SPECIFIC,
+		(void *)&reset_diag_cluster_revision
+	},
+	{
+		ZB_ZCL_NULL_ID,
+		0,
+		0,
+		0,
+		NULL
+	}
+};
+
+#endif /* CONFIG_RESET_DIAG_REPORT */
+
+/* Basic, Identify and On/Off, plus the optional clusters below */
+#define RELAY_SERVER_CLUSTER_COUNT \
+	(3 + IS_ENABLED(CONFIG_BATTERY_REPORT) + IS_ENABLED(CONFIG_RESET_DIAG_REPORT))
+
 /* Declare cluster list for Relay endpoint - simple On/Off Output device */
 zb_zcl_cluster_desc_t relay_switch_clusters[] =
 {
@@ -146,31 +232,49 @@ zb_zcl_cluster_desc_t relay_switch_clusters[] =
 		ZB_ZCL_CLUSTER_SERVER_ROLE,
 		ZB_ZCL_MANUF_CODE_INVALID
 	),
+#ifdef CONFIG_BATTERY_REPORT
 	ZB_ZCL_CLUSTER_DESC(
 		ZB_ZCL_CLUSTER_ID_POWER_CONFIG,
 		3,  /* 3 attributes: voltage, percentage, cluster revision */
 		(relay_power_config_attr_list),
 		ZB_ZCL_CLUSTER_SERVER_ROLE,
 		ZB_ZCL_MANUF_CODE_INVALID
-	)
+	),
+#endif
+#ifdef CONFIG_RESET_DIAG_REPORT
+	ZB_ZCL_CLUSTER_DESC(
+		ZB_ZCL_CLUSTER_ID_RESET_DIAG,
+		ZB_ZCL_ARRAY_SIZE(relay_reset_diag_attr_list, zb_zcl_attr_t),
+		(relay_reset_diag_attr_list),
+		ZB_ZCL_CLUSTER_SERVER_ROLE,
+		CONFIG_RESET_DIAG_MANUFACTURER_CODE
+	),
+#endif
 };
 
-/* Declare simple descriptor type for relay endpoint (4 server clusters, 0 client clusters) */
-ZB_DECLARE_SIMPLE_DESC(4, 0);
+/* Declare simple descriptor type for relay endpoint (up to 5 server clusters,
+ * 0 client clusters). The last slot is used by the reset diagnostics cluster.
+ */
+ZB_DECLARE_SIMPLE_DESC(5, 0);
 
-ZB_AF_SIMPLE_DESC_TYPE(4, 0) simple_desc_relay_switch_ep = {
+ZB_AF_SIMPLE_DESC_TYPE(5, 0) simple_desc_relay_switch_ep = {
 	RELAY_SWITCH_ENDPOINT,                /* Endpoint ID */
 	ZB_AF_HA_PROFILE_ID,                  /* Application profile identifier */
 	ZB_HA_ON_OFF_OUTPUT_DEVICE_ID,        /* Device ID - On/Off Output */
 	0,                                     /* Device version */
 	0,                                     /* Reserved */
-	4,                                     /* Number of input (server) clusters */
+	RELAY_SERVER_CLUSTER_COUNT,            /* Number of input (server) clusters */
 	0,                                     /* Number of output (client) clusters */
 	{
 		ZB_ZCL_CLUSTER_ID_BASIC,           /* Server: Basic */
 		ZB_ZCL_CLUSTER_ID_IDENTIFY,        /* Server: Identify */
 		ZB_ZCL_CLUSTER_ID_ON_OFF,          /* Server: On/Off */
+#ifdef CONFIG_BATTERY_REPORT
 		ZB_ZCL_CLUSTER_ID_POWER_CONFIG,    /* Server: Power Configuration */
+#endif
+#ifdef CONFIG_RESET_DIAG_REPORT
+		ZB_ZCL_CLUSTER_ID_RESET_DIAG,      /* Server: Reset diagnostics */
+#endif
 	}
 };
 
@@ -218,8 +322,12 @@ static zb_uint8_t zcl_on_off_handler(zb_bufid_t bufid)
 
 			if (device_cb_param->endpoint == RELAY_SWITCH_ENDPOINT) {
 				LOG_INF("Zigbee On/Off command for Relay: %s", new_value ? "ON" : "OFF");
+				/* Last writer wins: record the state now, actuate once
+				 * the burst is over. ZBOSS still updates the attribute
+				 * and answers every command.
+				 */
 				relay_ctx.relay_state = (new_value == ZB_TRUE);
-				relay_control_set(relay_ctx.relay_state);
+				onoff_collapse_command();
 			} else {
 				LOG_WRN("Unknown endpoint: %d", device_cb_param->endpoint);
 				device_cb_param->status = RET_ERROR;
@@ -235,6 +343,38 @@ static zb_uint8_t zcl_on_off_handler(zb_bufid_t bufid)
 }
 
 #ifdef CONFIG_ZIGBEE_FOTA
+/* Set when a rejected image has already reset the DFU target */
+static bool ota_rejected;
+
+static void ota_value_cb(zb_bufid_t bufid, zb_zcl_ota_upgrade_value_param_t *value)
+{
+	if (value->upgrade_status == ZB_ZCL_OTA_UPGRADE_STATUS_START) {
+		ota_rejected = false;
+	} else if (ota_rejected) {
+		/* Keep the rest of the rejected transfer, including the OTA
+		 * client's own abort, away from the FOTA library so the DFU
+		 * target is not reset a second time.
+		 */
+		if (value->upgrade_status == ZB_ZCL_OTA_UPGRADE_STATUS_ABORT) {
+			ota_rejected = false;
+		} else {
+			value->upgrade_status = ZB_ZCL_OTA_UPGRADE_STATUS_ERROR;
+		}
+		return;
+	}
+
+	zigbee_handlers_ota_value_cb(value);
+
+	/* Hash each block before it is written to the secondary slot */
+	if (!ota_verify_value_cb(value)) {
+		ota_rejected = true;
+		zigbee_handlers_ota_abort();
+		zigbee_fota_abort();
+		return;
+	}
+	zigbee_fota_zcl_cb(bufid);
+}
+
 static void zcl_device_cb(zb_bufid_t bufid)
 {
 	zb_zcl_device_callback_param_t *device_cb_param =
@@ -245,7 +385,7 @@ static void zcl_device_cb(zb_bufid_t bufid)
 	}
 
 	if (device_cb_param->device_cb_id == ZB_ZCL_OTA_UPGRADE_VALUE_CB_ID) {
-		zigbee_fota_zcl_cb(bufid);
+		ota_value_cb(bufid, &device_cb_param->cb_param.ota_value_param);
 	} else {
 		device_cb_param->status = RET_NOT_IMPLEMENTED;
 	}
@@ -263,15 +403,27 @@ static void zcl_device_cb(zb_bufid_t bufid)
 }
 #endif /* CONFIG_ZIGBEE_FOTA */
 
-void zigbee_device_init(void)
+void zigbee_device_restore_relay(void)
 {
-	/* Initialize relay state - start with relay OFF */
-	relay_ctx.relay_state = false;
-	relay_control_set(relay_ctx.relay_state);
+	bool on;
+
+	/* Power-on default is OFF; an update reboot hands over the last state */
+	if (crash_snapshot_take_relay_handover(&on)) {
+		relay_ctx.relay_state = on;
+		LOG_INF("Relay restored to %s after update reboot", on ? "ON" : "OFF");
+	}
+
+	actuation_request(0, relay_ctx.relay_state);
+	crash_snapshot_boot_phase(BOOT_PHASE_RELAY_RESTORED);
+}
 
+void zigbee_device_init(void)
+{
 	/* Basic cluster attributes data for relay endpoint */
 	relay_dev_ctx.basic_attr.zcl_version = ZB_ZCL_VERSION;
-	relay_dev_ctx.basic_attr.power_source = ZB_ZCL_BASIC_POWER_SOURCE_BATTERY;
+	relay_dev_ctx.basic_attr.power_source =
+		IS_ENABLED(CONFIG_ZIGBEE_ROLE_ROUTER) ? ZB_ZCL_BASIC_POWER_SOURCE_MAINS_SINGLE_PHASE
+						      : ZB_ZCL_BASIC_POWER_SOURCE_BATTERY;
 
 	ZB_ZCL_SET_STRING_VAL(relay_dev_ctx.manufacturer_name,
 			      (zb_uint8_t *)"FCApps",
@@ -281,7 +433,9 @@ void zigbee_device_init(void)
 			      (zb_uint8_t *)"Smart Relay v1",
 			      ZB_ZCL_STRING_CONST_SIZE("Smart Relay v1"));
 
-	/* On/Off cluster attributes for relay - sync with relay state. */
+	/* On/Off cluster attributes for relay - sync with the state
+	 * zigbee_device_restore_relay() has already driven.
+	 */
 	relay_dev_ctx.on_off_attr.on_off = relay_ctx.relay_state ? ZB_TRUE : ZB_FALSE;
 
 	/* Identify cluster attributes data for relay. */
@@ -290,7 +444,6 @@ void zigbee_device_init(void)
 	/* Power Configuration cluster attributes - initial battery state unknown */
 	battery_voltage = ZB_ZCL_POWER_CONFIG_BATTERY_VOLTAGE_INVALID;
 	battery_percentage = ZB_ZCL_POWER_CONFIG_BATTERY_REMAINING_UNKNOWN;
-	battery_voltage_last_reported = 0;
 
 	LOG_INF("Power Configuration attributes initialized");
 }
@@ -315,7 +468,8 @@ void zigbee_device_register(void)
 void zigbee_device_set_relay(bool on)
 {
 	relay_ctx.relay_state = on;
-	relay_control_set(relay_ctx.relay_state);
+	actuation_request(0, relay_ctx.relay_state);
+	crash_snapshot_trace(on ? CRASH_TRACE_RELAY_ON : CRASH_TRACE_RELAY_OFF);
 
 	/* Update Zigbee On/Off attribute for relay endpoint */
 	zb_uint8_t new_value = on ? ZB_TRUE : ZB_FALSE;
@@ -339,20 +493,132 @@ bool zigbee_device_toggle_relay(void)
 	return relay_ctx.relay_state;
 }
 
+/* APS data confirm of the relay report: the frame has left the radio */
+static void relay_report_confirm_cb(zb_bufid_t bufid)
+{
+	bool sent = (zb_buf_get_status(bufid) == RET_OK);
+
+	zb_buf_free(bufid);
+
+	if (relay_report_sent_cb) {
+		relay_report_sent_cb(sent);
+	}
+}
+
+/* Send On/Off attribute report to coordinator */
+static void send_relay_report(zb_bufid_t bufid)
+{
+	zb_uint8_t *cmd_ptr;
+	zb_uint16_t dst_addr = 0x0000;  /* Coordinator address */
+
+	cmd_ptr = ZB_ZCL_START_PACKET(bufid);
+
+	ZB_ZCL_CONSTRUCT_GENERAL_COMMAND_REQ_FRAME_CONTROL_A(
+		cmd_ptr,
+		ZB_ZCL_FRAME_DIRECTION_TO_CLI,
+		ZB_ZCL_NOT_MANUFACTURER_SPECIFIC,
+		ZB_ZCL_DISABLE_DEFAULT_RESPONSE);
+
+	ZB_ZCL_CONSTRUCT_COMMAND_HEADER(
+		cmd_ptr,
+		ZB_ZCL_GET_SEQ_NUM(),
+		ZB_ZCL_CMD_REPORT_ATTRIB);
+
+	ZB_ZCL_PACKET_PUT_DATA16_VAL(cmd_ptr, ZB_ZCL_ATTR_ON_OFF_ON_OFF_ID);
+	ZB_ZCL_PACKET_PUT_DATA8(cmd_ptr, ZB_ZCL_ATTR_TYPE_BOOL);
+	ZB_ZCL_PACKET_PUT_DATA8(cmd_ptr, relay_ctx.relay_state ? ZB_TRUE : ZB_FALSE);
+
+	ZB_ZCL_FINISH_N_SEND_PACKET(
+		bufid,
+		cmd_ptr,
+		dst_addr,
+		ZB_APS_ADDR_MODE_16_ENDP_PRESENT,
+		1,  /* Destination endpoint (coordinator) */
+		RELAY_SWITCH_ENDPOINT,
+		ZB_AF_HA_PROFILE_ID,
+		ZB_ZCL_CLUSTER_ID_ON_OFF,
+		relay_report_confirm_cb);
+}
+
+static void relay_report_cb(zb_uint8_t param)
+{
+	zb_bufid_t bufid;
+
+	if (param) {
+		bufid = param;
+	} else {
+		bufid = zb_buf_get_out();
+	}
+
+	if (!bufid) {
+		PERF_COUNT(ZBOSS_NO_BUF);
+		LOG_WRN("No buffer for relay report");
+		if (relay_report_sent_cb) {
+			relay_report_sent_cb(false);
+		}
+		return;
+	}
+
+	send_relay_report(bufid);
+	PERF_COUNT(REPORT_RELAY);
+	LOG_DBG("Relay report sent: %s", relay_ctx.relay_state ? "ON" : "OFF");
+}
+
+bool zigbee_device_report_relay(void (*sent_cb)(bool sent))
+{
+	if (!report_policy_relay()) {
+		return false;
+	}
+
+	relay_report_sent_cb = sent_cb;
+	schedule_app_tx(relay_report_cb);
+	return true;
+}
+
 bool zigbee_device_get_relay_state(void)
 {
 	return relay_ctx.relay_state;
 }
 
+/* Schedule an application-originated TX, holding it off while relay coil
+ * pulses leave no current headroom for the radio.
+ */
+static void schedule_app_tx(zb_callback_t cb)
+{
+	uint32_t holdoff_ms = actuation_scheduler_tx_holdoff_ms();
+
+	if (holdoff_ms) {
+		/* Round up so the alarm never fires inside the pulse */
+		ZB_SCHEDULE_APP_ALARM(cb, 0, ZB_MILLISECONDS_TO_BEACON_INTERVAL(holdoff_ms) + 1);
+	} else {
+		ZB_SCHEDULE_APP_CALLBACK(cb, 0);
+	}
+}
+
 void zigbee_device_set_network_joined(bool joined)
 {
-	network_joined = joined;
+	report_policy_set_joined(joined);
 	LOG_INF("Network joined status: %s", joined ? "true" : "false");
+
+	crash_snapshot_trace(joined ? CRASH_TRACE_JOINED : CRASH_TRACE_LEFT);
+	if (joined) {
+		crash_snapshot_boot_phase(BOOT_PHASE_JOINED);
+	}
+
+#ifdef CONFIG_RESET_DIAG_REPORT
+	/* Report why the previous run ended, once per boot */
+	if (joined && crash_snapshot_take(&reset_diag)) {
+		reset_diag_rejoin_ms = crash_snapshot_boot_phase_ms(BOOT_PHASE_JOINED);
+		reset_diag_trace[0] = CRASH_SNAPSHOT_TRACE_LEN;
+		memcpy(&reset_diag_trace[1], reset_diag.trace, CRASH_SNAPSHOT_TRACE_LEN);
+		schedule_app_tx(reset_diag_report_cb);
+	}
+#endif
 }
 
 bool zigbee_device_is_network_joined(void)
 {
-	return network_joined;
+	return report_policy_joined();
 }
 
 /* Send battery attribute report to coordinator */
@@ -411,11 +677,13 @@ static void battery_report_cb(zb_uint8_t param)
 	}
 
 	if (!bufid) {
+		PERF_COUNT(ZBOSS_NO_BUF);
 		LOG_WRN("No buffer for battery report");
 		return;
 	}
 
 	send_battery_report(bufid);
+	PERF_COUNT(REPORT_BATTERY);
 	LOG_INF("Battery report sent: %d.%02d V, %d%%",
 		battery_voltage / 100, battery_voltage % 100, battery_percentage / 2);
 }
@@ -438,29 +706,122 @@ void zigbee_device_update_battery(int32_t voltage_mv)
 	/* Convert to half-percent units (200 = 100%) */
 	zb_uint8_t new_percentage = (zb_uint8_t)(pct * 2);
 
-	/* Calculate voltage difference for threshold check */
-	zb_int16_t diff = (zb_int16_t)(new_voltage - battery_voltage_last_reported);
-	if (diff < 0) {
-		diff = -diff;
-	}
+	/* Keep the last reading in retained RAM for the reset snapshot */
+	crash_snapshot_set_battery(voltage_mv);
 
 	/* Update attributes */
 	battery_voltage = new_voltage;
 	battery_percentage = new_percentage;
 
-	LOG_DBG("Battery: %d.%02d V (%d units), %d%% (diff=%d)",
+	LOG_DBG("Battery: %d.%02d V (%d units), %d%%",
 		voltage_mv / 1000, (voltage_mv % 1000) / 10,
-		battery_voltage, pct, diff);
+		battery_voltage, pct);
 
 	/* Send report if change exceeds threshold and network is joined */
-	if (diff >= BATTERY_REPORT_THRESHOLD) {
-		battery_voltage_last_reported = battery_voltage;
-		if (network_joined) {
-			ZB_SCHEDULE_APP_CALLBACK(battery_report_cb, 0);
-			LOG_INF("Battery changed: %d.%02d V, %d%%",
-				voltage_mv / 1000, (voltage_mv % 1000) / 10, pct);
-		} else {
-			LOG_DBG("Battery change detected but network not joined, skipping report");
+	if (IS_ENABLED(CONFIG_BATTERY_REPORT) && report_policy_battery(battery_voltage)) {
+		schedule_app_tx(battery_report_cb);
+		LOG_INF("Battery changed: %d.%02d V, %d%%",
+			voltage_mv / 1000, (voltage_mv % 1000) / 10, pct);
+	}
+}
+
+#ifdef CONFIG_RESET_DIAG_REPORT
+/* Send manufacturer-specific reset diagnostics report to coordinator */
+static void send_reset_diag_report(zb_bufid_t bufid)
+{
+	zb_uint8_t *cmd_ptr;
+	zb_uint16_t dst_addr = 0x0000;  /* Coordinator address */
+
+	cmd_ptr = ZB_ZCL_START_PACKET(bufid);
+
+	ZB_ZCL_CONSTRUCT_GENERAL_COMMAND_REQ_FRAME_CONTROL_A(
+		cmd_ptr,
+		ZB_ZCL_FRAME_DIRECTION_TO_CLI,
+		ZB_ZCL_MANUFACTURER_SPECIFIC,
+		ZB_ZCL_DISABLE_DEFAULT_RESPONSE);
+
+	ZB_ZCL_CONSTRUCT_COMMAND_HEADER_EXT(
+		cmd_ptr,
+		ZB_ZCL_GET_SEQ_NUM(),
+		ZB_TRUE,
+		CONFIG_RESET_DIAG_MANUFACTURER_CODE,
+		ZB_ZCL_CMD_REPORT_ATTRIB);
+
+	ZB_ZCL_PACKET_PUT_DATA16_VAL(cmd_ptr, RESET_DIAG_ATTR_RESET_CAUSE);
+	ZB_ZCL_PACKET_PUT_DATA8(cmd_ptr, ZB_ZCL_ATTR_TYPE_U32);
+	ZB_ZCL_PACKET_PUT_DATA32_VAL(cmd_ptr, reset_diag.reset_cause);
+
+	ZB_ZCL_PACKET_PUT_DATA16_VAL(cmd_ptr, RESET_DIAG_ATTR_REJOIN_MS);
+	ZB_ZCL_PACKET_PUT_DATA8(cmd_ptr, ZB_ZCL_ATTR_TYPE_U32);
+	ZB_ZCL_PACKET_PUT_DATA32_VAL(cmd_ptr, reset_diag_rejoin_ms);
+
+	/* Retained fields are meaningless after a power-on/brown-out reset */
+	if (reset_diag.retained_valid) {
+		ZB_ZCL_PACKET_PUT_DATA16_VAL(cmd_ptr, RESET_DIAG_ATTR_FAULT_REASON);
+		ZB_ZCL_PACKET_PUT_DATA8(cmd_ptr, ZB_ZCL_ATTR_TYPE_U32);
+		ZB_ZCL_PACKET_PUT_DATA32_VAL(cmd_ptr, reset_diag.fault_reason);
+
+		ZB_ZCL_PACKET_PUT_DATA16_VAL(cmd_ptr, RESET_DIAG_ATTR_FAULT_PC);
+		ZB_ZCL_PACKET_PUT_DATA8(cmd_ptr, ZB_ZCL_ATTR_TYPE_U32);
+		ZB_ZCL_PACKET_PUT_DATA32_VAL(cmd_ptr, reset_diag.fault_pc);
+
+		ZB_ZCL_PACKET_PUT_DATA16_VAL(cmd_ptr, RESET_DIAG_ATTR_FAULT_LR);
+		ZB_ZCL_PACKET_PUT_DATA8(cmd_ptr, ZB_ZCL_ATTR_TYPE_U32);
+		ZB_ZCL_PACKET_PUT_DATA32_VAL(cmd_ptr, reset_diag.fault_lr);
+
+		ZB_ZCL_PACKET_PUT_DATA16_VAL(cmd_ptr, RESET_DIAG_ATTR_BATTERY_MV);
+		ZB_ZCL_PACKET_PUT_DATA8(cmd_ptr, ZB_ZCL_ATTR_TYPE_U16);
+		ZB_ZCL_PACKET_PUT_DATA16_VAL(cmd_ptr, reset_diag.battery_mv);
+
+		ZB_ZCL_PACKET_PUT_DATA16_VAL(cmd_ptr, RESET_DIAG_ATTR_UPTIME_S);
+		ZB_ZCL_PACKET_PUT_DATA8(cmd_ptr, ZB_ZCL_ATTR_TYPE_U32);
+		ZB_ZCL_PACKET_PUT_DATA32_VAL(cmd_ptr, reset_diag.uptime_s);
+
+		ZB_ZCL_PACKET_PUT_DATA16_VAL(cmd_ptr, RESET_DIAG_ATTR_TRACE);
+		ZB_ZCL_PACKET_PUT_DATA8(cmd_ptr, ZB_ZCL_ATTR_TYPE_OCTET_STRING);
+		for (size_t i = 0; i < sizeof(reset_diag_trace); i++) {
+			ZB_ZCL_PACKET_PUT_DATA8(cmd_ptr, reset_diag_trace[i]);
 		}
 	}
+
+	ZB_ZCL_FINISH_N_SEND_PACKET(
+		bufid,
+		cmd_ptr,
+		dst_addr,
+		ZB_APS_ADDR_MODE_16_ENDP_PRESENT,
+		1,  /* Destination endpoint (coordinator) */
+		RELAY_SWITCH_ENDPOINT,
+		ZB_AF_HA_PROFILE_ID,
+		ZB_ZCL_CLUSTER_ID_RESET_DIAG,
+		NULL);
+}
+
+static void reset_diag_report_cb(zb_uint8_t param)
+{
+	zb_bufid_t bufid;
+
+	if (param) {
+		bufid = param;
+	} else {
+		bufid = zb_buf_get_out();
+	}
+
+	if (!bufid) {
+		/* The snapshot is taken only once per boot: keep the report
+		 * pending until a buffer frees up instead of dropping it.
+		 */
+		PERF_COUNT(ZBOSS_NO_BUF);
+		LOG_WRN("No buffer for reset diagnostics report, retrying");
+		if (zb_buf_get_out_delayed(reset_diag_report_cb) != RET_OK) {
+			ZB_SCHEDULE_APP_ALARM(reset_diag_report_cb, 0,
+					      ZB_MILLISECONDS_TO_BEACON_INTERVAL(RESET_DIAG_RETRY_MS));
+		}
+		return;
+	}
+
+	send_reset_diag_report(bufid);
+	PERF_COUNT(REPORT_RESET_DIAG);
+	LOG_INF("Reset diagnostics sent: cause 0x%08x, fault %u at 0x%08x",
+		reset_diag.reset_cause, reset_diag.fault_reason, reset_diag.fault_pc);
 }
+#endif /* CONFIG_RESET_DIAG_REPORT */
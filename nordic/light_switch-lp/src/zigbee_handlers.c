@@ -21,11 +21,15 @@
 #include "zigbee_handlers.h"
 #include "zigbee_device.h"
 #include "gpio_control.h"
+#include "wdt_supervisor.h"
+#include "crash_snapshot.h"
+#include "perf_counters.h"
 
 #if CONFIG_ZIGBEE_FOTA
 #include <zigbee/zigbee_fota.h>
 #include <zephyr/sys/reboot.h>
 #include <zephyr/dfu/mcuboot.h>
+#include "ota_verify.h"
 #endif
 
 LOG_MODULE_REGISTER(zigbee_handlers, LOG_LEVEL_INF);
@@ -73,6 +77,18 @@ void identify_cb(zb_bufid_t bufid)
 }
 
 #ifdef CONFIG_ZIGBEE_FOTA
+/* Transfer start time and size, for comparing Zigbee OTA with the BLE SMP path */
+static int64_t ota_start_ms;
+static uint32_t ota_file_length;
+
+/* Forget the transfer and any relay handover: no update reboot follows */
+static void ota_state_clear(void)
+{
+	ota_start_ms = 0;
+	ota_file_length = 0;
+	crash_snapshot_clear_relay_handover();
+}
+
 static void confirm_image(void)
 {
 	if (!boot_is_img_confirmed()) {
@@ -86,15 +102,48 @@ static void confirm_image(void)
 	}
 }
 
+void zigbee_handlers_ota_value_cb(const zb_zcl_ota_upgrade_value_param_t *value)
+{
+	switch (value->upgrade_status) {
+	case ZB_ZCL_OTA_UPGRADE_STATUS_START:
+		ota_start_ms = k_uptime_get();
+		ota_file_length = value->upgrade.start.file_length;
+		LOG_INF("Zigbee OTA transfer started: %u B", ota_file_length);
+		break;
+
+	case ZB_ZCL_OTA_UPGRADE_STATUS_ABORT:
+		ota_state_clear();
+		break;
+
+	default:
+		break;
+	}
+}
+
+void zigbee_handlers_ota_abort(void)
+{
+	LOG_WRN("Zigbee OTA transfer aborted by the application");
+	ota_state_clear();
+}
+
 static void ota_evt_handler(const struct zigbee_fota_evt *evt)
 {
+	int64_t elapsed_ms;
+
 	switch (evt->id) {
 	case ZIGBEE_FOTA_EVT_PROGRESS:
 		led_power_set(evt->dl.progress % 2);
 		break;
 
 	case ZIGBEE_FOTA_EVT_FINISHED:
+		elapsed_ms = MAX(k_uptime_get() - ota_start_ms, 1);
+		LOG_INF("Zigbee OTA transfer complete: %u B in %lld ms (%lld B/s)",
+			ota_file_length, elapsed_ms,
+			((int64_t)ota_file_length * MSEC_PER_SEC) / elapsed_ms);
 		LOG_INF("Reboot application.");
+		crash_snapshot_trace(CRASH_TRACE_FOTA_FINISHED);
+		/* Restore the relay as soon as the new image starts */
+		crash_snapshot_set_relay_handover(zigbee_device_get_relay_state());
 		if (IS_ENABLED(CONFIG_RAM_POWER_DOWN_LIBRARY)) {
 			power_up_unused_ram();
 		}
@@ -103,6 +152,7 @@ static void ota_evt_handler(const struct zigbee_fota_evt *evt)
 
 	case ZIGBEE_FOTA_EVT_ERROR:
 		LOG_ERR("OTA image transfer failed.");
+		ota_state_clear();
 		break;
 
 	default:
@@ -115,6 +165,9 @@ void zigbee_handlers_init(void)
 {
 #ifdef CONFIG_ZIGBEE_FOTA
 	zigbee_fota_init(ota_evt_handler);
+	if (ota_verify_init()) {
+		LOG_WRN("OTA images will only be verified by MCUboot");
+	}
 	confirm_image();
 #endif
 }
@@ -126,6 +179,16 @@ void zboss_signal_handler(zb_bufid_t bufid)
 	zb_zdo_app_signal_type_t sig = zb_get_app_signal(bufid, &sig_hndler);
 	zb_ret_t status = ZB_GET_APP_SIGNAL_STATUS(bufid);
 
+	/* Every signal (including can-sleep before each sleep period) proves
+	 * the ZBOSS thread is alive.
+	 */
+	wdt_supervisor_checkin(WDT_CTX_ZBOSS);
+
+	if (sig == ZB_COMMON_SIGNAL_CAN_SLEEP) {
+		/* One per sleep period, so one per poll or alarm wake-up */
+		PERF_COUNT(WAKE_ZBOSS);
+	}
+
 #if IS_ENABLED(CONFIG_DK_LIBRARY) && (IS_ENABLED(CONFIG_CONSOLE) || IS_ENABLED(CONFIG_LOG))
 	/* Development mode - indicate network status using LEDs. */
 	if (sig == ZB_BDB_SIGNAL_DEVICE_FIRST_START ||